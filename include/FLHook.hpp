@@ -11,6 +11,7 @@
 #include <filesystem>
 #include <variant>
 #include <numbers>
+#include <bit>
 
 #define _WINSOCK_DEPRECATED_NO_WARNINGS
 #include "WinSock2.h"
@@ -23,6 +24,8 @@ using namespace magic_enum::bitwise_operators; // NOLINT
 using namespace magic_enum::ostream_operators; // NOLINT
 
 DLL void ProcessEvent(std::wstring text, ...);
+//! Whether anything receives the events passed to ProcessEvent, either a socket in event mode or a plugin hook
+DLL bool HasEventSubscribers();
 
 // Tools
 class DLL Console
@@ -167,11 +170,17 @@ struct DLL FLHookConfig final : Reflectable, Singleton<FLHookConfig>
 		float torpMissileBaseDamageMultiplier = 1.0f;
 		//! If true, it logs performance of functions if they take too long to execute.
 		bool logPerformanceTimers = false;
+		//! Minimum time in milliseconds between two queued saves of the same character.
+		uint characterSaveInterval = 5000;
+		//! Time in milliseconds that may be spent writing queued character saves per server tick. At least one save is written per tick.
+		uint characterSaveBudget = 2;
 
 		bool tempBansEnabled = true;
 
 		//! A vector of forbidden words/phrases, which will not be processed and sent to other players
 		std::vector<std::wstring> chatSuppressList;
+		//! chatSuppressList compiled on load, messages starting with any of the entries are suppressed
+		PrefixMatcher chatSuppressMatcher;
 		//! Vector of systems where players can't deal damage to one another.
 		std::vector<std::string> noPVPSystems;
 
@@ -292,6 +301,16 @@ struct DLL FLHookConfig final : Reflectable, Singleton<FLHookConfig>
 		uint userCmdMaxIgnoreList = 0;
 		//! If true, the default player chat will be local, not system.
 		bool defaultLocalChat = false;
+		//! Commands a player can send in a row before being throttled, e.g. 10. 0 disables the command count limit
+		uint userCmdRateLimitBurst = 0;
+		//! Commands per minute a player regains after a burst
+		uint userCmdRateLimitPerMinute = 60;
+		//! Milliseconds of server time the commands of a player may take in a row before being throttled, e.g. 250. 0 disables the cost limit
+		uint userCmdCostBudgetMs = 0;
+		//! Milliseconds of server time per minute a player regains
+		uint userCmdCostBudgetPerMinuteMs = 600;
+		//! If true, log when a player starts being throttled
+		bool logThrottledUserCmds = true;
 	};
 
 	struct Bans final : Reflectable
@@ -621,6 +640,7 @@ class CCmds
 	void CmdIsOnServer(const std::wstring& player);
 	void CmdMoneyFixList();
 	void CmdServerInfo();
+	void CmdObjectCacheStats();
 	void CmdGetGroupMembers(const std::variant<uint, std::wstring>& player);
 
 	void CmdSaveChar(const std::variant<uint, std::wstring>& player);
@@ -630,6 +650,7 @@ class CCmds
 	void CmdSetAdmin(const std::variant<uint, std::wstring>& player, const std::wstring& wscRights);
 	void CmdGetAdmin(const std::variant<uint, std::wstring>& player);
 	void CmdDelAdmin(const std::variant<uint, std::wstring>& player);
+	void CmdReloadAdmins();
 
 	void CmdLoadPlugins();
 	void CmdLoadPlugin(const std::wstring& wscPlugin);
@@ -670,6 +691,11 @@ class CInGame final : public CCmds
 
 class CSocket final : public CCmds
 {
+	bool bBuffering;
+	std::wstring wscBuffer;
+
+	void Send(std::wstring text);
+
   public:
 	SOCKET s;
 	BLOWFISH_CTX* bfc;
@@ -685,9 +711,15 @@ class CSocket final : public CCmds
 		bAuthed = false;
 		bEventMode = false;
 		bUnicode = false;
+		bBuffering = false;
 	}
 	DLL void DoPrint(const std::string& text) override;
 	DLL std::wstring GetAdminName() override;
+
+	// Collects everything printed from now on instead of sending it line by line
+	DLL void BeginBuffer();
+	// Sends everything collected since BeginBuffer at once
+	DLL void FlushBuffer();
 };
 
 // FuncLog
@@ -704,6 +736,34 @@ DLL void UserCmd_SetChatFont(ClientId& client, const std::wstring& wscParam);
 DLL void PrintUserCmdText(ClientId client, const std::wstring& text);
 DLL void PrintLocalUserCmdText(ClientId client, const std::wstring& wscMsg, float fDistance);
 
+/// <summary>
+/// Collects the lines of a user command reply and sends them as paragraphs of as few chat messages as possible, instead of one
+/// message per line. Everything printed is sent when Flush is called or the writer goes out of scope.
+/// </summary>
+class DLL UserCmdWriter
+{
+	//! Above this many characters of XML a new chat message is started, longer messages are cut off by the client
+	static constexpr size_t MaxMessageLength = 2048;
+
+	uint client;
+	std::wstring xml;
+
+	void AddLine(std::wstring_view line);
+
+  public:
+	explicit UserCmdWriter(ClientId client);
+	~UserCmdWriter();
+	UserCmdWriter(const UserCmdWriter&) = delete;
+	UserCmdWriter& operator=(const UserCmdWriter&) = delete;
+
+	/// <summary>
+	/// Adds text to the reply, every \n in it starts a new line.
+	/// </summary>
+	void Print(const std::wstring& text);
+
+	void Flush();
+};
+
 DLL extern bool g_NonGunHitsBase;
 DLL extern float g_LastHitPts;
 
@@ -750,6 +810,9 @@ extern DLL IClientImpl* HookClient;
 extern DLL char* OldClient;
 
 extern DLL std::array<CLIENT_INFO, MaxClientId + 1> ClientInfo;
+extern DLL std::array<CLIENT_INFO_COLD, MaxClientId + 1> ClientInfoCold;
+
+inline CLIENT_INFO_COLD& CLIENT_INFO::Cold() const { return ClientInfoCold[this - ClientInfo.data()]; }
 
 DLL std::string FlcDecode(std::string& input);
 DLL std::string FlcEncode(std::string& input);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <FLHook.hpp>
+
+/// <summary>
+/// In memory copy of the flhookadmin.ini files in the account directories, so checking the rights of an in game admin does not
+/// touch the file system. Changes made through Hk::Admin are applied directly, files edited by hand are picked up by Refresh or
+/// the reloadadmins command.
+/// </summary>
+class DLL AdminRights : public Singleton<AdminRights>
+{
+	struct Entry
+	{
+		std::string rights;
+		//! Last write time of the file when it was read, used to detect edits
+		int64 fileTime = 0;
+	};
+
+	//! Keyed by the lower case account directory name
+	std::unordered_map<std::wstring, Entry> admins;
+
+	static std::string GetAdminFilePath(const std::wstring& accountDir);
+	static int64 GetFileTime(const std::string& path);
+
+  public:
+	/// <summary>
+	/// Discards the cache and reads the admin file of every account directory.
+	/// </summary>
+	/// <returns>The number of admin accounts found.</returns>
+	size_t Load();
+
+	/// <summary>
+	/// Re-reads the admin files that changed on disk since they were read and drops the ones that were deleted. Only looks at known
+	/// admin accounts, an admin file created by hand is found by the next Load.
+	/// </summary>
+	void Refresh();
+
+	/// <summary>
+	/// Writes the admin file of the account and stores the rights.
+	/// </summary>
+	/// <param name="accountDir">The account directory name.</param>
+	/// <param name="rights">The rights as accepted by setadmin, e.g. "cash,kickban".</param>
+	void Set(const std::wstring& accountDir, const std::string& rights);
+
+	/// <summary>
+	/// Deletes the admin file of the account and forgets its rights.
+	/// </summary>
+	void Remove(const std::wstring& accountDir);
+
+	/// <returns>The rights string of the account, or nothing if it is not an admin.</returns>
+	std::optional<std::string> Get(const std::wstring& accountDir) const;
+};
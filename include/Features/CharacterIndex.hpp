@@ -0,0 +1,88 @@
+#pragma once
+
+#include <FLHook.hpp>
+
+/// <summary>
+/// Persistent copy of the data of every character file that is needed without the character being online, such as the money of
+/// an offline character. Resolving names to accounts and files is left to server.dll, which already keeps those in memory.
+/// </summary>
+class DLL CharacterIndex : public Singleton<CharacterIndex>
+{
+  public:
+	struct Character
+	{
+		std::wstring characterName;
+		std::wstring accountDir;
+		//! The name of the character file without the .fl extension
+		std::wstring charFile;
+		int64 money = 0;
+		uint systemId = 0;
+		//! The base the character is docked at, 0 if it was saved in space
+		uint baseId = 0;
+		//! Unix timestamp of the last time the character was logged in
+		int64 lastLogin = 0;
+		//! Last write time of the character file when it was indexed, used to detect edits made while FLHook was not watching
+		int64 fileTime = 0;
+	};
+
+  private:
+	SQLite::Database db = SqlHelpers::Create("characters.sqlite");
+
+	//! Updates from the save hook waiting to be written, keyed by account directory and character file
+	std::unordered_map<std::wstring, Character> pendingUpdates;
+
+	static std::optional<Character> ReadCharacterFile(const std::wstring& accountDir, const std::wstring& charFile);
+	static std::string GetCharacterPath(const std::wstring& accountDir, const std::wstring& charFile);
+	static int64 GetFileTime(const std::string& path);
+
+	void Store(const Character& character);
+
+  public:
+	CharacterIndex();
+
+	/// <summary>
+	/// Brings the index in line with the character files in the account directory. Files that are new or were written since they were
+	/// indexed are read in parallel, entries whose file no longer exists are dropped. Called on startup, so edits made while the server
+	/// was down are picked up.
+	/// </summary>
+	void Build();
+
+	/// <summary>
+	/// Updates the entry of an online character from memory. Called after the server saved the character. The update is only queued,
+	/// it is written together with the other updates of the tick by Flush.
+	/// </summary>
+	/// <param name="client">The client whose character was just saved.</param>
+	void UpdateFromClient(ClientId client);
+
+	/// <summary>
+	/// Writes the queued updates in a single transaction. Called once per server tick, and before any read or removal.
+	/// </summary>
+	void Flush();
+
+	/// <summary>
+	/// Re-reads a single character file and updates its entry.
+	/// </summary>
+	/// <param name="accountDir">The account directory name.</param>
+	/// <param name="charFile">The character file name without the .fl extension.</param>
+	void UpdateFromFile(const std::wstring& accountDir, const std::wstring& charFile);
+
+	/// <summary>
+	/// Removes a character from the index, for example after a rename or deletion.
+	/// </summary>
+	void RemoveCharacter(const std::wstring& characterName);
+
+	/// <summary>
+	/// Looks up an offline or online character by name. Entries whose file changed on disk since they were indexed are re-read,
+	/// entries whose file no longer exists are dropped.
+	/// </summary>
+	/// <param name="characterName">The character name, case insensitive.</param>
+	/// <returns>The indexed character in the event of success, otherwise Error::CharacterDoesNotExist.</returns>
+	cpp::result<Character, Error> GetCharacter(const std::wstring& characterName);
+
+	/// <summary>
+	/// Reads the character name from a character file without going through server.dll. Safe to call from worker threads.
+	/// </summary>
+	/// <param name="path">The full path to the character file.</param>
+	/// <returns>The name, or nothing if the file could not be read.</returns>
+	static std::optional<std::wstring> ReadCharacterName(const std::string& path);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <FLHook.hpp>
+
+/// <summary>
+/// Uniform hash grid of the positions of all player ships in space, one grid per system. Positions are refreshed from the
+/// client position updates, so they lag the server side position by at most one update.
+/// </summary>
+class DLL PlayerGrid : public Singleton<PlayerGrid>
+{
+	//! Edge length of a cell in meters. Chosen to be in the range of the usual local chat and docking message distances
+	static constexpr float CellSize = 5000.0f;
+
+	struct Entry
+	{
+		uint system = 0;
+		uint64 cell = 0;
+		Vector position = {};
+	};
+
+	std::array<Entry, MaxClientId + 1> entries;
+	std::unordered_map<uint, std::unordered_map<uint64, std::vector<uint>>> systems;
+
+	static int GetCellCoordinate(float value);
+	static uint64 GetCellKey(int x, int y, int z);
+
+	void Unlink(ClientId client);
+
+  public:
+	/// <summary>
+	/// Stores the position of a player ship, moving it to another cell or system if necessary.
+	/// </summary>
+	/// <param name="client">The client whose ship moved.</param>
+	/// <param name="system">The system the ship is in.</param>
+	/// <param name="position">The position of the ship.</param>
+	void Update(ClientId client, uint system, const Vector& position);
+
+	/// <summary>
+	/// Reads the current system and ship position of the client from the server and stores them. Removes the client if it is not in space.
+	/// </summary>
+	void UpdateFromShip(ClientId client);
+
+	/// <summary>
+	/// Removes the client from the grid, for example when it docks, dies or disconnects.
+	/// </summary>
+	void Remove(ClientId client);
+
+	/// <summary>
+	/// Finds all players in space whose last known position lies within the radius.
+	/// </summary>
+	/// <param name="system">The system to search.</param>
+	/// <param name="position">The center of the search.</param>
+	/// <param name="radius">The search radius in meters.</param>
+	/// <returns>The client ids of the players found, in no particular order.</returns>
+	std::vector<uint> QueryRadius(uint system, const Vector& position, float radius) const;
+
+	/// <returns>The last known position of the client's ship, or nothing if the client is not in space.</returns>
+	std::optional<Vector> GetPosition(ClientId client) const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <FLHook.hpp>
+
+#include <deque>
+
+class DLL SaveScheduler : public Singleton<SaveScheduler>
+{
+	struct SaveState
+	{
+		bool queued = false;
+		mstime lastSave = 0;
+	};
+
+	std::array<SaveState, MaxClientId + 1> saveStates;
+	std::deque<uint> saveQueue;
+
+  public:
+	/// <summary>
+	/// Queues a character save for the specified client. Multiple requests for the same client are merged into one save,
+	/// which is performed once the minimum save interval has passed and the per tick time budget allows it.
+	/// </summary>
+	/// <param name="client">The client whose character should be saved.</param>
+	void QueueSave(ClientId client);
+
+	/// <summary>
+	/// Saves the character immediately, dropping any pending save for it. Use this when the save has to be on disk
+	/// before continuing, for example before a kick or a rename.
+	/// </summary>
+	/// <param name="player">The client id or character name of an online player.</param>
+	cpp::result<void, Error> SaveNow(const std::variant<uint, std::wstring>& player);
+
+	/// <summary>
+	/// Saves the character immediately if a save is pending for it.
+	/// </summary>
+	/// <param name="client">The client whose pending save should be written.</param>
+	void FlushClient(ClientId client);
+
+	/// <summary>
+	/// Records that the character of this client was just written to disk. Called by Hk::Player::SaveChar.
+	/// </summary>
+	void MarkSaved(ClientId client);
+
+	/// <summary>
+	/// Works through the queue until the configured time budget is spent. Called once per server tick.
+	/// </summary>
+	void ProcessQueue();
+
+	bool IsPending(ClientId client) const;
+	size_t GetPendingCount() const;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+/// <summary>
+/// Open addressing hash map keyed by nonzero object ids or non null pointers. All entries live inline in a single power of two sized array, so once
+/// the map has grown to its working size inserts and erases no longer allocate. Erasing shifts the following entries of the
+/// probe sequence back instead of leaving tombstones, which keeps lookups short under constant insert/erase churn.
+/// </summary>
+/// <typeparam name="T">The mapped value, std::monostate turns the map into a set.</typeparam>
+/// <typeparam name="Key">An unsigned integer or pointer type.</typeparam>
+template<typename T, typename Key = uint>
+class FlatIdMap
+{
+	struct Slot
+	{
+		//! 0 marks an empty slot, which is why 0 cannot be used as a key
+		Key key = {};
+		T value = {};
+	};
+
+	std::vector<Slot> slots;
+	size_t count = 0;
+
+	[[nodiscard]] size_t GetMask() const { return slots.size() - 1; }
+
+	static size_t GetHash(Key key)
+	{
+		uint64 bits;
+		if constexpr (std::is_pointer_v<Key>)
+			bits = reinterpret_cast<uintptr_t>(key);
+		else
+			bits = key;
+
+		// Object ids and heap addresses are close to each other, mix them so they do not end up in neighbouring slots
+		bits ^= bits >> 33;
+		bits *= 0xFF51AFD7ED558CCDull;
+		bits ^= bits >> 33;
+		return static_cast<size_t>(bits);
+	}
+
+	[[nodiscard]] size_t FindSlot(Key key) const
+	{
+		for (size_t index = GetHash(key) & GetMask();; index = (index + 1) & GetMask())
+		{
+			if (slots[index].key == key || !slots[index].key)
+				return index;
+		}
+	}
+
+	void Grow()
+	{
+		std::vector<Slot> oldSlots(slots.empty() ? 64 : slots.size() * 2);
+		oldSlots.swap(slots);
+		for (auto& slot : oldSlots)
+		{
+			if (slot.key)
+				slots[FindSlot(slot.key)] = std::move(slot);
+		}
+	}
+
+  public:
+	/// <returns>A pointer to the value stored for the key, or nullptr if there is none. Invalidated by the next insert or erase.</returns>
+	[[nodiscard]] T* Find(Key key)
+	{
+		if (!key || slots.empty())
+			return nullptr;
+
+		auto& slot = slots[FindSlot(key)];
+		return slot.key ? &slot.value : nullptr;
+	}
+
+	[[nodiscard]] const T* Find(Key key) const { return const_cast<FlatIdMap*>(this)->Find(key); }
+
+	[[nodiscard]] bool Contains(Key key) const { return Find(key) != nullptr; }
+
+	/// <summary>
+	/// Inserts or overwrites the value stored for the key.
+	/// </summary>
+	/// <param name="key">The id, must not be 0.</param>
+	/// <param name="value">The value to store.</param>
+	T& Insert(Key key, const T& value = {})
+	{
+		// Keep the load factor at or below 3/4, beyond that linear probe sequences grow quickly
+		if ((count + 1) * 4 > slots.size() * 3)
+			Grow();
+
+		auto& slot = slots[FindSlot(key)];
+		if (!slot.key)
+		{
+			slot.key = key;
+			count++;
+		}
+
+		slot.value = value;
+		return slot.value;
+	}
+
+	/// <returns>True if the key was stored in the map.</returns>
+	bool Erase(Key key)
+	{
+		if (!key || slots.empty())
+			return false;
+
+		size_t hole = FindSlot(key);
+		if (!slots[hole].key)
+			return false;
+
+		// Move every following entry of the probe sequence that may live in the hole into it
+		for (size_t index = (hole + 1) & GetMask(); slots[index].key; index = (index + 1) & GetMask())
+		{
+			const size_t home = GetHash(slots[index].key) & GetMask();
+			if (((index - home) & GetMask()) >= ((index - hole) & GetMask()))
+			{
+				slots[hole] = std::move(slots[index]);
+				hole = index;
+			}
+		}
+
+		slots[hole] = {};
+		count--;
+		return true;
+	}
+
+	void Clear()
+	{
+		slots.clear();
+		count = 0;
+	}
+
+	[[nodiscard]] size_t Size() const { return count; }
+	[[nodiscard]] size_t Capacity() const { return slots.size(); }
+};
+
+using FlatIdSet = FlatIdMap<std::monostate>;
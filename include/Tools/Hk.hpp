@@ -135,6 +135,18 @@ namespace Hk
 		DLL cpp::result<const std::wstring, Error> GetPlayerSystem(ClientId client);
 		DLL cpp::result<const std::wstring, Error> GetSystemNickByID(uint systemId);
 		DLL std::vector<uint> getAllPlayersInSystem(SystemId system);
+
+		/**
+		 * Iterates the online players of a system without allocating:
+		 * for (uint player = GetFirstPlayerInSystem(system); player; player = GetNextPlayerInSystem(player))
+		 * @returns The first client in the system, or 0 if there is nobody in it.
+		 */
+		DLL ClientId GetFirstPlayerInSystem(SystemId system);
+
+		/**
+		 * @returns The next client in the same system as the specified one, or 0 at the end of the list.
+		 */
+		DLL ClientId GetNextPlayerInSystem(ClientId client);
 		DLL cpp::result<void, Error> LockAccountAccess(CAccount* acc, bool bKick);
 		DLL cpp::result<void, Error> UnlockAccountAccess(CAccount* acc);
 		DLL cpp::result<void, Error> PlaySoundEffect(ClientId client, uint soundId);
@@ -190,6 +202,33 @@ namespace Hk
 		DLL cpp::result<void, Error> FMsg(const std::variant<uint, std::wstring>& player, const std::wstring& wscXML);
 		DLL cpp::result<void, Error> FMsgS(const std::variant<std::wstring, uint>& system, const std::wstring& wscXML);
 		DLL cpp::result<void, Error> FMsgU(const std::wstring& wscXML);
+
+		/**
+		 * Encodes an XML formatted message once, so it can be broadcast repeatedly without being encoded again.
+		 * @param xml The message in the same format FMsg takes.
+		 * @returns The encoded message or Error::WrongXmlSyntax.
+		 */
+		DLL cpp::result<EncodedMessage, Error> EncodeXML(const std::wstring& xml);
+
+		/**
+		 * Sends an encoded message to every client in the list.
+		 */
+		DLL void Broadcast(const EncodedMessage& message, const std::vector<uint>& clients);
+
+		/**
+		 * Sends an encoded message to every player in the system, using the per system player lists.
+		 */
+		DLL void BroadcastToSystem(const EncodedMessage& message, uint systemId);
+
+		/**
+		 * Sends an encoded message to every player on the server.
+		 */
+		DLL void BroadcastToAll(const EncodedMessage& message);
+
+		/**
+		 * @returns The number of formatted messages and bytes sent to clients since the server started.
+		 */
+		DLL BroadcastStats GetBroadcastStats();
 		DLL std::wstring FormatMsg(MessageColor color, MessageFormat format, const std::wstring& msg);
 		DLL std::wstring GetWStringFromIdS(uint iIdS);
 		DLL void LoadStringDLLs();
@@ -286,6 +325,28 @@ namespace Hk
 		DLL float GetCharacterIniFloat(ClientId client, const std::wstring& name);
 		DLL double GetCharacterIniDouble(ClientId client, const std::wstring& name);
 		DLL int64_t GetCharacterIniInt64(ClientId client, const std::wstring& name);
+
+		//! Identifies a [flhook] key, obtained once through InternCharacterIniKey to avoid repeated string lookups. A distinct type so it
+		//! cannot be swapped with the client id by accident.
+		enum class CharacterIniKey : uint
+		{
+		};
+		using CharacterIniValue = std::variant<std::wstring, bool, int64, double>;
+
+		//! Every distinct name passed here, or to SetCharacterIni by name, is kept until the server shuts down. Use a fixed set of names,
+		//! never ones built from player input or ids.
+		DLL CharacterIniKey InternCharacterIniKey(const std::wstring& name);
+		DLL void SetCharacterIni(ClientId client, CharacterIniKey key, std::wstring value);
+		DLL void SetCharacterIniBool(ClientId client, CharacterIniKey key, bool value);
+		DLL void SetCharacterIniInt64(ClientId client, CharacterIniKey key, int64 value);
+		DLL void SetCharacterIniDouble(ClientId client, CharacterIniKey key, double value);
+		DLL std::wstring GetCharacterIniString(ClientId client, CharacterIniKey key);
+		DLL bool GetCharacterIniBool(ClientId client, CharacterIniKey key);
+		DLL int GetCharacterIniInt(ClientId client, CharacterIniKey key);
+		DLL uint GetCharacterIniUint(ClientId client, CharacterIniKey key);
+		DLL float GetCharacterIniFloat(ClientId client, CharacterIniKey key);
+		DLL double GetCharacterIniDouble(ClientId client, CharacterIniKey key);
+		DLL int64 GetCharacterIniInt64(ClientId client, CharacterIniKey key);
 	} // namespace Ini
 
 	namespace Admin
@@ -324,6 +385,8 @@ namespace Hk
 		DLL void ReadSystemZones(std::multimap<uint, LootableZone, std::less<>>& zones, const std::string& systemNick, const std::string& file);
 		DLL bool InZone(uint systemId, const Vector& pos, Zone& rlz);
 		DLL bool InDeathZone(uint systemId, const Vector& pos, Zone& rlz);
+		DLL void InZones(uint systemId, const ZonePositions& positions, ZoneMembership& membership);
+		DLL const Zone* GetMembershipZone(const ZoneMembership& membership, size_t zone);
 		DLL SystemInfo* GetSystemInfo(uint systemId);
 		DLL void PrintZones();
 	} // namespace ZoneUtilities
@@ -42,6 +42,81 @@ struct IGNORE_INFO
 	std::wstring wscFlags;
 };
 
+/** The ignore list of a client. The entries keep the order they are stored in flhookuser.ini in, and are compiled on every change:
+ * names without the "i" flag go into a hash map, so checking a sender costs one lookup plus a substring search per "i" entry */
+class IgnoreList
+{
+	struct Partial
+	{
+		std::wstring name;
+		bool privateOnly;
+	};
+
+	std::list<IGNORE_INFO> entries;
+	//! Lower case names of the exact entries, mapped to whether all entries for the name only affect private chat
+	std::unordered_map<std::wstring, bool> exactNames;
+	std::vector<Partial> partialNames;
+
+	static std::wstring Fold(std::wstring text)
+	{
+		std::ranges::transform(text, text.begin(), towlower);
+		return text;
+	}
+
+	void Compile()
+	{
+		exactNames.clear();
+		partialNames.clear();
+		for (const auto& ignore : entries)
+		{
+			const bool privateOnly = ignore.wscFlags.find(L'p') != std::wstring::npos;
+			if (ignore.wscFlags.find(L'i') != std::wstring::npos)
+				partialNames.push_back({Fold(ignore.character), privateOnly});
+			else if (const auto [name, inserted] = exactNames.try_emplace(Fold(ignore.character), privateOnly); !inserted)
+				name->second &= privateOnly;
+		}
+	}
+
+  public:
+	[[nodiscard]] const std::list<IGNORE_INFO>& GetEntries() const { return entries; }
+	[[nodiscard]] size_t Size() const { return entries.size(); }
+
+	void Add(const IGNORE_INFO& ignore)
+	{
+		entries.push_back(ignore);
+		Compile();
+	}
+
+	void Clear()
+	{
+		entries.clear();
+		Compile();
+	}
+
+	/** Removes the entries at the given 1 based positions, ids past the end are ignored */
+	void Erase(const std::vector<uint>& ids)
+	{
+		uint id = 1;
+		std::erase_if(entries, [&ids, &id](const IGNORE_INFO&) { return std::ranges::find(ids, id++) != ids.end(); });
+		Compile();
+	}
+
+	/** @returns True if messages from the sender should not be shown. Entries with the "p" flag only apply to private chat */
+	[[nodiscard]] bool IsIgnored(const std::wstring& sender, bool privateChat) const
+	{
+		if (entries.empty())
+			return false;
+
+		const std::wstring name = Fold(sender);
+		if (const auto exact = exactNames.find(name); exact != exactNames.end() && (privateChat || !exact->second))
+			return true;
+
+		return std::ranges::any_of(partialNames, [&name, privateChat](const Partial& partial) {
+			return (privateChat || !partial.privateOnly) && name.find(partial.name) != std::wstring::npos;
+		});
+	}
+};
+
 // resolver
 struct RESOLVE_IP
 {
@@ -51,18 +126,45 @@ struct RESOLVE_IP
 	std::wstring wscHostname;
 };
 
-struct CLIENT_INFO
+// How many user commands and how much server time a client has left
+struct UserCmdBudget
 {
-	// kill msgs
-	uint ship;
-	uint shipOld;
-	mstime tmSpawnTime;
+	//! 0 until the first command, which starts with a full budget
+	mstime lastRefill = 0;
+	double commands = 0.0;
+	//! Can go below 0 after an expensive command, the client then has to wait until it is paid back
+	double costMs = 0.0;
+	//! Set while commands are being refused, so only the start of a throttle is logged
+	bool throttled = false;
+};
 
+// Per client state that is only needed on rare events like deaths, chat filtering or connects. Kept apart from CLIENT_INFO so the
+// frequently scanned ClientInfo array stays small.
+struct CLIENT_INFO_COLD
+{
+	// kill msgs
 	DamageList dmgLast;
 
 	// money cmd
 	std::list<MONEY_FIX> lstMoneyFix;
 
+	// ignore usercommand
+	IgnoreList ignoreList;
+
+	// user command rate limit
+	UserCmdBudget userCmdBudget;
+
+	// other
+	std::wstring wscHostname;
+};
+
+struct CLIENT_INFO
+{
+	// kill msgs
+	uint ship;
+	uint shipOld;
+	mstime tmSpawnTime;
+
 	// anticheat
 	uint iTradePartner;
 
@@ -88,9 +190,6 @@ struct CLIENT_INFO
 	mstime tmF1Time;
 	mstime tmF1TimeDisconnect;
 
-	// ignore usercommand
-	std::list<IGNORE_INFO> lstIgnore;
-
 	// user settings
 	DIEMSGTYPE dieMsg;
 	CHATSIZE dieMsgSize;
@@ -105,8 +204,6 @@ struct CLIENT_INFO
 	uint iGroupId;
 
 	// other
-	std::wstring wscHostname;
-
 	bool bSpawnProtected;
 	bool bUseServersideHitDetection; // used by AC Plugin
 
@@ -114,6 +211,101 @@ struct CLIENT_INFO
 	uint formationNumber1;
 	uint formationNumber2;
 	uint formationTag;
+
+	// Cold() finds the matching ClientInfoCold entry by the position of this object in ClientInfo, so only the entries of that array
+	// may exist. Copies or locals would silently refer to the wrong client.
+	CLIENT_INFO() = default;
+	CLIENT_INFO(const CLIENT_INFO&) = delete;
+	CLIENT_INFO(CLIENT_INFO&&) = delete;
+	CLIENT_INFO& operator=(const CLIENT_INFO&) = delete;
+	CLIENT_INFO& operator=(CLIENT_INFO&&) = delete;
+
+	/// <summary>
+	/// Returns the rarely used state of this client, which lives in ClientInfoCold.
+	/// </summary>
+	CLIENT_INFO_COLD& Cold() const;
+
+	// Compatibility with code written before the cold members were moved out, prefer ClientInfoCold[client] in new code
+	DamageList& GetDmgLast() const { return Cold().dmgLast; }
+	std::list<MONEY_FIX>& GetMoneyFix() const { return Cold().lstMoneyFix; }
+	const std::list<IGNORE_INFO>& GetIgnore() const { return Cold().ignoreList.GetEntries(); }
+	std::wstring& GetHostname() const { return Cold().wscHostname; }
+	__declspec(property(get = GetDmgLast)) DamageList& dmgLast;
+	__declspec(property(get = GetMoneyFix)) std::list<MONEY_FIX>& lstMoneyFix;
+	__declspec(property(get = GetIgnore)) const std::list<IGNORE_INFO>& lstIgnore;
+	__declspec(property(get = GetHostname)) std::wstring& wscHostname;
+};
+
+/** Case insensitive matching of text against a set of prefixes. The prefixes are compiled into a trie, so a match costs one step per
+ * character of the text regardless of how many prefixes there are */
+class PrefixMatcher
+{
+	struct Node
+	{
+		//! Sorted by character
+		std::vector<std::pair<wchar_t, uint>> children;
+		bool terminal = false;
+	};
+
+	std::vector<Node> nodes = {Node {}};
+
+  public:
+	void Add(const std::wstring& prefix)
+	{
+		uint node = 0;
+		for (const wchar_t c : prefix)
+		{
+			const wchar_t lower = towlower(c);
+			auto& children = nodes[node].children;
+			auto child = std::ranges::lower_bound(children, lower, {}, &std::pair<wchar_t, uint>::first);
+			if (child == children.end() || child->first != lower)
+			{
+				const uint index = nodes.size();
+				children.insert(child, {lower, index});
+				nodes.emplace_back();
+				node = index;
+			}
+			else
+				node = child->second;
+		}
+		nodes[node].terminal = true;
+	}
+
+	/** @returns True if the text starts with any of the prefixes */
+	[[nodiscard]] bool Matches(std::wstring_view text) const
+	{
+		uint node = 0;
+		for (const wchar_t c : text)
+		{
+			if (nodes[node].terminal)
+				return true;
+
+			const auto& children = nodes[node].children;
+			const auto child = std::ranges::lower_bound(children, static_cast<wchar_t>(towlower(c)), {}, &std::pair<wchar_t, uint>::first);
+			if (child == children.end() || child->first != towlower(c))
+				return false;
+
+			node = child->second;
+		}
+		return nodes[node].terminal;
+	}
+
+	[[nodiscard]] bool Empty() const { return nodes.size() == 1 && !nodes[0].terminal; }
+};
+
+/** A chat message in its binary RDL form. Copies share the payload, so a message can be encoded once and sent any number of times */
+struct EncodedMessage
+{
+	std::shared_ptr<const std::vector<char>> payload;
+
+	[[nodiscard]] uint GetSize() const { return payload ? payload->size() : 0; }
+};
+
+/** Totals of the formatted chat messages FLHook sent directly to clients */
+struct BroadcastStats
+{
+	uint64 packets = 0;
+	uint64 bytes = 0;
 };
 
 // taken from directplay
@@ -263,6 +455,61 @@ struct Zone
 	bool encounter;
 };
 
+/** Positions of several objects in one system in structure of arrays layout, used for batched zone queries */
+struct ZonePositions
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+
+	void Add(const Vector& pos)
+	{
+		x.emplace_back(pos.x);
+		y.emplace_back(pos.y);
+		z.emplace_back(pos.z);
+	}
+
+	void Clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+	}
+
+	size_t Size() const { return x.size(); }
+};
+
+/** The result of a batched zone query, one bit per zone of the system for every queried position. Zones are referred to by index,
+ Hk::ZoneUtilities::GetMembershipZone turns an index into the zone for as long as the universe is not read again. */
+struct ZoneMembership
+{
+	uint systemId = 0;
+
+	/** Counts the reads of the universe, used to detect indices that no longer refer to the same zones */
+	uint generation = 0;
+
+	/** The number of zones in the system, bit i of a mask refers to the i-th zone of the system in the order InZone checks them */
+	size_t zoneCount = 0;
+
+	/** The number of 64 bit words used for the mask of a single position */
+	size_t wordsPerPosition = 0;
+
+	std::vector<uint64> masks;
+
+	bool Contains(size_t position, size_t zone) const { return masks[position * wordsPerPosition + zone / 64] & (1ULL << (zone % 64)); }
+
+	/** Returns the index of the zone that InZone would have returned for this position, or nothing */
+	std::optional<size_t> GetFirstZone(size_t position) const
+	{
+		for (size_t word = 0; word < wordsPerPosition; word++)
+		{
+			if (const uint64 mask = masks[position * wordsPerPosition + word])
+				return word * 64 + std::countr_zero(mask);
+		}
+		return std::nullopt;
+	}
+};
+
 class JumpPoint
 {
   public:
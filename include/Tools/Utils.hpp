@@ -84,7 +84,12 @@ inline std::chrono::sys_time<std::chrono::seconds> UnixToSysTime(int64 time)
 
 inline std::wstring XMLText(const std::wstring& text)
 {
+	// Most messages contain nothing to escape
+	if (text.find_first_of(L"<>&") == std::wstring::npos)
+		return text;
+
 	std::wstring wscRet;
+	wscRet.reserve(text.length() + 16);
 	for (uint i = 0; (i < text.length()); i++)
 	{
 		if (text[i] == '<')
@@ -30,22 +30,36 @@
 
 // Includes
 #include "Autobuy.h"
+#include "Features/SaveScheduler.hpp"
 
 namespace Plugins::Autobuy
 {
 	const std::unique_ptr<Global> global = std::make_unique<Global>();
 
+	// The [flhook] keys are interned once instead of being looked up by name on every access
+	namespace Keys
+	{
+		const Hk::Ini::CharacterIniKey missiles = Hk::Ini::InternCharacterIniKey(L"autobuy.missiles");
+		const Hk::Ini::CharacterIniKey mines = Hk::Ini::InternCharacterIniKey(L"autobuy.mines");
+		const Hk::Ini::CharacterIniKey torps = Hk::Ini::InternCharacterIniKey(L"autobuy.torps");
+		const Hk::Ini::CharacterIniKey cd = Hk::Ini::InternCharacterIniKey(L"autobuy.cd");
+		const Hk::Ini::CharacterIniKey cm = Hk::Ini::InternCharacterIniKey(L"autobuy.cm");
+		const Hk::Ini::CharacterIniKey bb = Hk::Ini::InternCharacterIniKey(L"autobuy.bb");
+		const Hk::Ini::CharacterIniKey repairs = Hk::Ini::InternCharacterIniKey(L"autobuy.repairs");
+		const Hk::Ini::CharacterIniKey shells = Hk::Ini::InternCharacterIniKey(L"autobuy.shells");
+	} // namespace Keys
+
 	void LoadPlayerAutobuy(ClientId client)
 	{
 		AutobuyInfo playerAutobuyInfo {};
-		playerAutobuyInfo.missiles = Hk::Ini::GetCharacterIniBool(client, L"autobuy.missiles");
-		playerAutobuyInfo.mines = Hk::Ini::GetCharacterIniBool(client, L"autobuy.mines");
-		playerAutobuyInfo.torps = Hk::Ini::GetCharacterIniBool(client, L"autobuy.torps");
-		playerAutobuyInfo.cd = Hk::Ini::GetCharacterIniBool(client, L"autobuy.cd");
-		playerAutobuyInfo.cm = Hk::Ini::GetCharacterIniBool(client, L"autobuy.cm");
-		playerAutobuyInfo.bb = Hk::Ini::GetCharacterIniBool(client, L"autobuy.bb");
-		playerAutobuyInfo.repairs = Hk::Ini::GetCharacterIniBool(client, L"autobuy.repairs");
-		playerAutobuyInfo.shells = Hk::Ini::GetCharacterIniBool(client, L"autobuy.shells");
+		playerAutobuyInfo.missiles = Hk::Ini::GetCharacterIniBool(client, Keys::missiles);
+		playerAutobuyInfo.mines = Hk::Ini::GetCharacterIniBool(client, Keys::mines);
+		playerAutobuyInfo.torps = Hk::Ini::GetCharacterIniBool(client, Keys::torps);
+		playerAutobuyInfo.cd = Hk::Ini::GetCharacterIniBool(client, Keys::cd);
+		playerAutobuyInfo.cm = Hk::Ini::GetCharacterIniBool(client, Keys::cm);
+		playerAutobuyInfo.bb = Hk::Ini::GetCharacterIniBool(client, Keys::bb);
+		playerAutobuyInfo.repairs = Hk::Ini::GetCharacterIniBool(client, Keys::repairs);
+		playerAutobuyInfo.shells = Hk::Ini::GetCharacterIniBool(client, Keys::shells);
 		global->autobuyInfo[client] = playerAutobuyInfo;
 	}
 
@@ -445,7 +459,7 @@ namespace Plugins::Autobuy
 				PrintUserCmdText(client, std::format(L"Auto-Buy({}): Bought {} unit(s), cost: {}$", buy.description, buy.count, ToMoneyStr(uCost)));
 			}
 		}
-		Hk::Player::SaveChar(client);
+		SaveScheduler::i()->QueueSave(client);
 	}
 
 	void UserCmdAutobuy(ClientId& client, const std::wstring& param)
@@ -509,54 +523,54 @@ namespace Plugins::Autobuy
 			autobuyInfo.cm = enable;
 			autobuyInfo.bb = enable;
 			autobuyInfo.repairs = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.missiles", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.mines", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.shells", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.torps", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.cd", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.cm", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.bb", stows(enable ? "true" : "false"));
-			Hk::Ini::SetCharacterIni(client, L"autobuy.repairs", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::missiles, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::mines, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::shells, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::torps, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::cd, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::cm, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::bb, enable);
+			Hk::Ini::SetCharacterIniBool(client, Keys::repairs, enable);
 		}
 		else if (autobuyType == L"missiles")
 		{
 			autobuyInfo.missiles = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.missiles", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::missiles, enable);
 		}
 		else if (autobuyType == L"mines")
 		{
 			autobuyInfo.mines = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.mines", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::mines, enable);
 		}
 		else if (autobuyType == L"shells")
 		{
 			autobuyInfo.shells = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.shells", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::shells, enable);
 		}
 		else if (autobuyType == L"torps")
 		{
 			autobuyInfo.torps = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.torps", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::torps, enable);
 		}
 		else if (autobuyType == L"cd")
 		{
 			autobuyInfo.cd = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.cd", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::cd, enable);
 		}
 		else if (autobuyType == L"cm")
 		{
 			autobuyInfo.cm = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.cm", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::cm, enable);
 		}
 		else if (autobuyType == L"bb")
 		{
 			autobuyInfo.bb = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.bb", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::bb, enable);
 		}
 		else if (autobuyType == L"repairs")
 		{
 			autobuyInfo.repairs = enable;
-			Hk::Ini::SetCharacterIni(client, L"autobuy.repairs", stows(enable ? "true" : "false"));
+			Hk::Ini::SetCharacterIniBool(client, Keys::repairs, enable);
 		}
 		else
 		{
@@ -564,7 +578,7 @@ namespace Plugins::Autobuy
 			return;
 		}
 
-		Hk::Player::SaveChar(client);
+		SaveScheduler::i()->QueueSave(client);
 		PrintUserCmdText(client, L"OK");
 	}
 
@@ -22,6 +22,7 @@
  */
 
 #include "CrashCatcher.h"
+#include "Features/SaveScheduler.hpp"
 
 namespace Plugins::CrashCatcher
 {
@@ -89,7 +90,7 @@ namespace Plugins::CrashCatcher
 			if (saveTime != 0 && saveTime < currTime)
 			{
 				if (Hk::Client::IsValidClientID(client) && !Hk::Client::IsInCharSelectMenu(client))
-					Hk::Player::SaveChar(client);
+					SaveScheduler::i()->QueueSave(client);
 				saveTime = 0;
 			}
 		}
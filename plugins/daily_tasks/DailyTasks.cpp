@@ -267,7 +267,7 @@ namespace Plugins::DailyTasks
 			{
 				const DamageList* dmg = *damage;
 				const auto killerId = Hk::Client::GetClientIdByShip(
-				    dmg->get_cause() == DamageCause::Unknown ? ClientInfo[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
+				    dmg->get_cause() == DamageCause::Unknown ? ClientInfoCold[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
 				const auto victimId = Hk::Client::GetClientIdByShip(ship->get_id());
 				for (auto& task : global->accountTasks[Hk::Client::GetAccountByClientID(killerId.value())].tasks)
 				{
@@ -291,7 +291,7 @@ namespace Plugins::DailyTasks
 			{
 				const DamageList* dmg = *damage;
 				const auto killerId = Hk::Client::GetClientIdByShip(
-				    dmg->get_cause() == DamageCause::Unknown ? ClientInfo[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
+				    dmg->get_cause() == DamageCause::Unknown ? ClientInfoCold[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
 				int reputation;
 				pub::SpaceObj::GetRep(ship->get_id(), reputation);
 				uint affiliation;
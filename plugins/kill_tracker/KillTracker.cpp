@@ -122,7 +122,7 @@ namespace Plugins::KillTracker
 			{
 				const DamageList* dmg = *_dmg;
 				const auto killerId = Hk::Client::GetClientIdByShip(
-				    dmg->get_cause() == DamageCause::Unknown ? ClientInfo[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
+				    dmg->get_cause() == DamageCause::Unknown ? ClientInfoCold[client].dmgLast.get_inflictor_id() : dmg->get_inflictor_id());
 				const auto victimId = Hk::Client::GetClientIdByShip(cShip->get_id());
 
 				if (killerId.has_value() && victimId.has_value() && killerId.value() != client)
@@ -35,6 +35,7 @@
  */
 #include "LightControl.h"
 #include "refl.hpp"
+#include "Features/SaveScheduler.hpp"
 
 namespace Plugins::LightControl
 {
@@ -311,7 +312,7 @@ namespace Plugins::LightControl
 			}
 		}
 
-		Hk::Player::SaveChar(client);
+		SaveScheduler::i()->QueueSave(client);
 		PrintUserCmdText(client, L"Light(s) successfully changed, when you are finished with all your changes, log off for them to take effect. ");
 	}
 
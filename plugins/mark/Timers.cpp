@@ -1,4 +1,5 @@
 #include "Mark.h"
+#include "Features/PlayerGrid.hpp"
 
 namespace Plugins::Mark
 {
@@ -82,19 +83,10 @@ namespace Plugins::Mark
 				auto [itemPosition, _] = Hk::Solar::GetLocation(mark->iObj, IdType::Solar).value();
 
 				SystemId iItemSystem = Hk::Solar::GetSystemBySpaceId(mark->iObj).value();
-				// for all players
-				PlayerData* playerData = nullptr;
-				while ((playerData = Players.traverse_active(playerData)))
+				// for all players in range of the item
+				for (const uint client : PlayerGrid::c()->QueryRadius(iItemSystem, itemPosition, LOOT_UNSEEN_RADIUS))
 				{
-					ClientId client = playerData->iOnlineId;
-					if (Players[client].systemId == iItemSystem)
-					{
-						auto [playerPosition, _] = Hk::Solar::GetLocation(Players[client].shipId, IdType::Ship).value();
-						if (Hk::Math::Distance3D(playerPosition, itemPosition) <= LOOT_UNSEEN_RADIUS)
-						{
-							MarkObject(client, mark->iObj);
-						}
-					}
+					MarkObject(client, mark->iObj);
 				}
 				mark = global->DelayedMarks.erase(mark);
 			}
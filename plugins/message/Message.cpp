@@ -106,22 +106,28 @@ namespace Plugins::Message
 		ShowGreetingBanner(client);
 	}
 
+	/** @ingroup Message
+	 * @brief Encodes a banner line once so it can be sent to every player. Lines without their own formatting get the user command style.
+	 */
+	static cpp::result<EncodedMessage, Error> EncodeBannerLine(const std::wstring& line)
+	{
+		if (line.find(L"<TRA") == 0)
+			return Hk::Message::EncodeXML(line);
+
+		// Same layout UserCmdWriter gives multi-line text
+		const std::wstring text = ReplaceStr(XMLText(line), L"\n", L"</TEXT><PARA/><TEXT>");
+		return Hk::Message::EncodeXML(std::format(L"<TRA data=\"{}\" mask=\"-1\"/><TEXT>{}</TEXT>", FLHookConfig::c()->messages.msgStyle.userCmdStyle, text));
+	}
+
 	/** @ingroup Message
 	 * @brief Show the special banner to all players.
 	 */
 	static void ShowSpecialBanner()
 	{
-		PlayerData* playerData = nullptr;
-		while ((playerData = Players.traverse_active(playerData)))
+		for (const auto& line : global->config->specialBannerLines)
 		{
-			ClientId client = playerData->iOnlineId;
-			for (const auto& line : global->config->specialBannerLines)
-			{
-				if (line.find(L"<TRA") == 0)
-					Hk::Message::FMsg(client, line);
-				else
-					PrintUserCmdText(client, line);
-			}
+			if (const auto message = EncodeBannerLine(line); message.has_value())
+				Hk::Message::BroadcastToAll(message.value());
 		}
 	}
 
@@ -137,16 +143,8 @@ namespace Plugins::Message
 		if (++curStandardBanner >= global->config->standardBannerLines.size())
 			curStandardBanner = 0;
 
-		PlayerData* playerData = nullptr;
-		while ((playerData = Players.traverse_active(playerData)))
-		{
-			ClientId client = playerData->iOnlineId;
-
-			if (global->config->standardBannerLines[curStandardBanner].find(L"<TRA") == 0)
-				Hk::Message::FMsg(client, global->config->standardBannerLines[curStandardBanner]);
-			else
-				PrintUserCmdText(client, global->config->standardBannerLines[curStandardBanner].c_str());
-		}
+		if (const auto message = EncodeBannerLine(global->config->standardBannerLines[curStandardBanner]); message.has_value())
+			Hk::Message::BroadcastToAll(message.value());
 	}
 
 	/** @ingroup Message
@@ -447,20 +445,8 @@ namespace Plugins::Message
 	 */
 	void RedText(const std::wstring& XMLMsg, uint systemId)
 	{
-		char szBuf[0x1000];
-		uint iRet;
-		if (const auto err = Hk::Message::FMsgEncodeXML(XMLMsg, szBuf, sizeof(szBuf), iRet); err.has_error())
-			return;
-
-		// Send to all players in system
-		PlayerData* playerData = nullptr;
-		while ((playerData = Players.traverse_active(playerData)))
-		{
-			ClientId client = playerData->iOnlineId;
-
-			if (SystemId iClientSystemId = Hk::Player::GetSystem(client).value(); systemId == iClientSystemId)
-				Hk::Message::FMsgSendChat(client, szBuf, iRet);
-		}
+		if (const auto message = Hk::Message::EncodeXML(XMLMsg); message.has_value())
+			Hk::Message::BroadcastToSystem(message.value(), systemId);
 	}
 
 	/** @ingroup Message
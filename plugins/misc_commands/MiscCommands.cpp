@@ -38,6 +38,7 @@
  */
 
 #include "MiscCommands.h"
+#include "Features/PlayerGrid.hpp"
 
 namespace Plugins::MiscCommands
 {
@@ -318,25 +319,12 @@ namespace Plugins::MiscCommands
 		music.iMusicId = global->smiteMusicHash;
 		pub::Audio::SetMusic(playerInfo.value().client, music);
 
-		// For all players in system...
-		PlayerData* playerData = nullptr;
-		while ((playerData = Players.traverse_active(playerData)))
+		// For all players in space within scanner range (15K) of the sending char...
+		for (const uint client : PlayerGrid::c()->QueryRadius(playerInfo.value().iSystem, fromShipPos, 14999.0f))
 		{
-			// Get the this player's current system and location in the system.
-			ClientId client = playerData->iOnlineId;
 			if (client == playerInfo.value().client)
 				continue;
 
-			if (playerInfo.value().iSystem != Hk::Player::GetSystem(client).value())
-				continue;
-
-			uint ship = Hk::Player::GetShip(client).value();
-
-			const auto& [playerPosition, _] = Hk::Solar::GetLocation(ship, IdType::Ship).value();
-			// Is player within scanner range (15K) of the sending char.
-			if (Hk::Math::Distance3D(playerPosition, fromShipPos) > 14999)
-				continue;
-
 			pub::Audio::SetMusic(client, music);
 
 			global->mapInfo[client].shieldsDown = true;
@@ -1,4 +1,5 @@
 ﻿#include "Global.hpp"
+#include "Features/AdminRights.hpp"
 
 #define RIGHT_CHECK(a)               \
 	if (!(this->rights & a))         \
@@ -13,6 +14,91 @@
 		return;                              \
 	}
 
+/** An admin command of the core. Plugin commands are dispatched through the FLHook__AdminCommand__Process hook instead */
+struct AdminCommand
+{
+	//! The arguments as listed by help
+	std::wstring_view usage;
+	//! The rights needed to run the command, RIGHT_SUPERADMIN requires all of them
+	DWORD rights;
+	void (*handler)(CCmds& cmds);
+};
+
+const std::unordered_map<std::wstring_view, AdminCommand> adminCommands = {
+    {L"getcash", {L"<charname>", RIGHT_CASH, [](CCmds& cmds) { cmds.CmdGetCash(cmds.ArgCharname(1)); }}},
+    {L"setcash", {L"<charname> <amount>", RIGHT_CASH, [](CCmds& cmds) { cmds.CmdSetCash(cmds.ArgCharname(1), cmds.ArgUInt(2)); }}},
+    {L"addcash", {L"<charname> <amount>", RIGHT_CASH, [](CCmds& cmds) { cmds.CmdAddCash(cmds.ArgCharname(1), cmds.ArgUInt(2)); }}},
+    {L"kick", {L"<charname> <reason>", RIGHT_KICKBAN, [](CCmds& cmds) { cmds.CmdKick(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"ban", {L"<charname>", RIGHT_KICKBAN, [](CCmds& cmds) { cmds.CmdBan(cmds.ArgCharname(1)); }}},
+    {L"tempban", {L"<charname> <minutes>", RIGHT_KICKBAN, [](CCmds& cmds) { cmds.CmdTempBan(cmds.ArgCharname(1), cmds.ArgUInt(2)); }}},
+    {L"unban", {L"<charname>", RIGHT_KICKBAN, [](CCmds& cmds) { cmds.CmdUnban(cmds.ArgCharname(1)); }}},
+    {L"getclientid", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetClientID(cmds.ArgCharname(1)); }}},
+    {L"beam", {L"<charname> <basename>", RIGHT_BEAMKILL, [](CCmds& cmds) { cmds.CmdBeam(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"kill", {L"<charname>", RIGHT_BEAMKILL, [](CCmds& cmds) { cmds.CmdKill(cmds.ArgCharname(1)); }}},
+    {L"resetrep", {L"<charname>", RIGHT_REPUTATION, [](CCmds& cmds) { cmds.CmdResetRep(cmds.ArgCharname(1)); }}},
+    {L"setrep",
+        {L"<charname> <repgroup> <value>",
+            RIGHT_REPUTATION,
+            [](CCmds& cmds) { cmds.CmdSetRep(cmds.ArgCharname(1), cmds.ArgStr(2), cmds.ArgFloat(3)); }}},
+    {L"getrep", {L"<charname> <repgroup>", RIGHT_REPUTATION, [](CCmds& cmds) { cmds.CmdGetRep(cmds.ArgCharname(1), cmds.ArgStr(2)); }}},
+    {L"msg", {L"<charname> <text>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdMsg(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"msgs", {L"<systemname> <text>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdMsgS(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"msgu", {L"<text>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdMsgU(cmds.ArgStrToEnd(1)); }}},
+    {L"fmsg", {L"<charname> <xml>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdFMsg(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"fmsgs", {L"<systemname> <xml>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdFMsgS(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"fmsgu", {L"<xml>", RIGHT_MSG, [](CCmds& cmds) { cmds.CmdFMsgU(cmds.ArgStrToEnd(1)); }}},
+    {L"enumcargo", {L"<charname>", RIGHT_CARGO, [](CCmds& cmds) { cmds.CmdEnumCargo(cmds.ArgCharname(1)); }}},
+    {L"removecargo",
+        {L"<charname> <id> <count>",
+            RIGHT_CARGO,
+            [](CCmds& cmds) { cmds.CmdRemoveCargo(cmds.ArgCharname(1), static_cast<ushort>(cmds.ArgInt(2)), cmds.ArgInt(3)); }}},
+    {L"addcargo",
+        {L"<charname> <good> <count> <mission>",
+            RIGHT_CARGO,
+            [](CCmds& cmds) { cmds.CmdAddCargo(cmds.ArgCharname(1), cmds.ArgStr(2), cmds.ArgInt(3), cmds.ArgInt(4)); }}},
+    {L"rename", {L"<charname> <newcharname>", RIGHT_CHARACTERS, [](CCmds& cmds) { cmds.CmdRename(cmds.ArgCharname(1), cmds.ArgStr(2)); }}},
+    {L"deletechar", {L"<charname>", RIGHT_CHARACTERS, [](CCmds& cmds) { cmds.CmdDeleteChar(cmds.ArgCharname(1)); }}},
+    {L"readcharfile", {L"<charname>", RIGHT_CHARACTERS, [](CCmds& cmds) { cmds.CmdReadCharFile(cmds.ArgCharname(1)); }}},
+    {L"writecharfile", {L"<charname> <data>", RIGHT_CHARACTERS, [](CCmds& cmds) { cmds.CmdWriteCharFile(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"getplayerinfo", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetPlayerInfo(cmds.ArgCharname(1)); }}},
+    {L"getplayers", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetPlayers(); }}},
+    {L"xgetplayerinfo", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdXGetPlayerInfo(cmds.ArgCharname(1)); }}},
+    {L"xgetplayers", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdXGetPlayers(); }}},
+    {L"getplayerids", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetPlayerIds(); }}},
+    {L"getaccountdirname", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetAccountDirName(cmds.ArgCharname(1)); }}},
+    {L"getcharfilename", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetCharFileName(cmds.ArgCharname(1)); }}},
+    {L"savechar", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdSaveChar(cmds.ArgCharname(1)); }}},
+    {L"isonserver", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdIsOnServer(cmds.ArgCharname(1)); }}},
+    {L"moneyfixlist", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdMoneyFixList(); }}},
+    {L"serverinfo", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdServerInfo(); }}},
+    {L"objcachestats", {L"", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdObjectCacheStats(); }}},
+    {L"getgroupmembers", {L"<charname>", RIGHT_OTHER, [](CCmds& cmds) { cmds.CmdGetGroupMembers(cmds.ArgCharname(1)); }}},
+    {L"getreservedslot", {L"<charname>", RIGHT_SETTINGS, [](CCmds& cmds) { cmds.CmdGetReservedSlot(cmds.ArgCharname(1)); }}},
+    {L"setreservedslot", {L"<charname> <0/1>", RIGHT_SETTINGS, [](CCmds& cmds) { cmds.CmdSetReservedSlot(cmds.ArgCharname(1), cmds.ArgInt(2)); }}},
+    {L"setadmin", {L"<charname> <rights>", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdSetAdmin(cmds.ArgCharname(1), cmds.ArgStrToEnd(2)); }}},
+    {L"getadmin", {L"<charname>", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdGetAdmin(cmds.ArgCharname(1)); }}},
+    {L"deladmin", {L"<charname>", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdDelAdmin(cmds.ArgCharname(1)); }}},
+    {L"reloadadmins", {L"", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdReloadAdmins(); }}},
+    {L"unloadplugin", {L"<shortname>", RIGHT_PLUGINS, [](CCmds& cmds) { cmds.CmdUnloadPlugin(cmds.ArgStrToEnd(1)); }}},
+    {L"loadplugins", {L"", RIGHT_PLUGINS, [](CCmds& cmds) { cmds.CmdLoadPlugins(); }}},
+    {L"reloadplugin", {L"<shortname>", RIGHT_PLUGINS, [](CCmds& cmds) { cmds.CmdReloadPlugin(cmds.ArgStrToEnd(1)); }}},
+    {L"loadplugin", {L"<filename>", RIGHT_PLUGINS, [](CCmds& cmds) { cmds.CmdLoadPlugin(cmds.ArgStrToEnd(1)); }}},
+    {L"shutdown", {L"", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdShutdown(); }}},
+    {L"listplugins", {L"", RIGHT_PLUGINS, [](CCmds& cmds) { cmds.CmdListPlugins(); }}},
+    {L"help", {L"", RIGHT_NOTHING, [](CCmds& cmds) { cmds.CmdHelp(); }}},
+    {L"move",
+        {L"<x> <y> <z>",
+            RIGHT_SUPERADMIN,
+            [](CCmds& cmds) { cmds.CmdMove(cmds.GetAdminName(), cmds.ArgFloat(1), cmds.ArgFloat(2), cmds.ArgFloat(3)); }}},
+    {L"chase", {L"<charname>", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdChase(cmds.GetAdminName(), cmds.ArgCharname(1)); }}},
+    {L"pull", {L"<charname>", RIGHT_SUPERADMIN, [](CCmds& cmds) { cmds.CmdPull(cmds.GetAdminName(), cmds.ArgCharname(1)); }}},
+};
+
+bool HasRights(DWORD rights, DWORD required)
+{
+	return required == RIGHT_SUPERADMIN ? rights == RIGHT_SUPERADMIN : (rights & required) == required;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void CCmds::CmdGetCash(const std::variant<uint, std::wstring>& player)
@@ -572,7 +658,7 @@ void CCmds::CmdMoneyFixList()
 	{
 		ClientId client = playerDb->iOnlineId;
 
-		if (ClientInfo[client].lstMoneyFix.size())
+		if (ClientInfoCold[client].lstMoneyFix.size())
 			Print(std::format("id={}", client));
 	}
 
@@ -606,9 +692,40 @@ void CCmds::CmdServerInfo()
 	uint iSeconds = iUptime;
 	std::string time = std::format("{}:{}:{}:{}", iDays, iHours, iMinutes, iSeconds);
 
+	const auto broadcastStats = Hk::Message::GetBroadcastStats();
+
 	// print
-	Print(std::format(
-	    "serverload={} npcspawn={} uptime={}\nOK\n", CoreGlobals::c()->serverLoadInMs, CoreGlobals::c()->disableNpcs ? "disabled" : "enabled", time));
+	Print(std::format("serverload={} npcspawn={} uptime={} chatpackets={} chatbytes={}\nOK\n",
+	    CoreGlobals::c()->serverLoadInMs,
+	    CoreGlobals::c()->disableNpcs ? "disabled" : "enabled",
+	    time,
+	    broadcastStats.packets,
+	    broadcastStats.bytes));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CCmds::CmdObjectCacheStats()
+{
+	RIGHT_CHECK(RIGHT_OTHER);
+
+	const auto print = [this](const char* cache, const IEngineHook::ObjectCacheStats& stats) {
+		Print(std::format("cache={} hits={} misses={} evictions={} size={} capacity={}",
+		    cache,
+		    stats.hits,
+		    stats.misses,
+		    stats.evictions,
+		    stats.size,
+		    stats.capacity));
+	};
+
+	print("solar", IEngineHook::GetSolarCacheStats());
+	print("nonsolar", IEngineHook::GetNonSolarCacheStats());
+
+	for (const auto& [objClass, count] : IEngineHook::GetLiveObjectCounts())
+		Print(std::format("class={} live={}", objClass, count));
+
+	Print("OK");
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -725,6 +842,15 @@ void CCmds::CmdDelAdmin(const std::variant<uint, std::wstring>& player)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void CCmds::CmdReloadAdmins()
+{
+	RIGHT_CHECK_SUPERADMIN();
+
+	Print(std::format("admins={}\nOK\n", AdminRights::i()->Load()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void CCmds::CmdLoadPlugins()
 {
 	RIGHT_CHECK(RIGHT_PLUGINS);
@@ -789,7 +915,7 @@ void CCmds::CmdUnloadPlugin(const std::wstring& wscPlugin)
 
 void CCmds::CmdShutdown()
 {
-	RIGHT_CHECK(RIGHT_SUPERADMIN);
+	RIGHT_CHECK_SUPERADMIN();
 
 	Print("Shutting down Server");
 
@@ -937,7 +1063,18 @@ void CCmds::CmdMove(std::wstring adminName, float x, float y, float z)
 
 void CCmds::CmdHelp()
 {
-	// TODO: Reimplement
+	std::vector<std::pair<std::wstring_view, std::wstring_view>> available;
+	for (const auto& [name, command] : adminCommands)
+	{
+		if (HasRights(rights, command.rights))
+			available.emplace_back(name, command.usage);
+	}
+
+	std::ranges::sort(available);
+	for (const auto& [name, usage] : available)
+		Print(wstos(usage.empty() ? std::wstring(name) : std::format(L"{} {}", name, usage)));
+
+	Print("OK");
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1100,226 +1237,12 @@ void CCmds::ExecuteCommandString(const std::wstring& wscCmdStr)
 
 		if (const bool plugins = CallPluginsBefore(HookedCall::FLHook__AdminCommand__Process, this, wscCmd); !plugins)
 		{
-			if (wscCmd == L"getcash")
-			{
-				CmdGetCash(ArgCharname(1));
-			}
-			else if (wscCmd == L"setcash")
-			{
-				CmdSetCash(ArgCharname(1), ArgUInt(2));
-			}
-			else if (wscCmd == L"addcash")
-			{
-				CmdAddCash(ArgCharname(1), ArgUInt(2));
-			}
-			else if (wscCmd == L"kick")
-			{
-				CmdKick(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"ban")
-			{
-				CmdBan(ArgCharname(1));
-			}
-			else if (wscCmd == L"tempban")
-			{
-				CmdTempBan(ArgCharname(1), ArgUInt(2));
-			}
-			else if (wscCmd == L"unban")
-			{
-				CmdUnban(ArgCharname(1));
-			}
-			else if (wscCmd == L"getclientid")
-			{
-				CmdGetClientID(ArgCharname(1));
-			}
-			else if (wscCmd == L"beam")
-			{
-				CmdBeam(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"kill")
-			{
-				CmdKill(ArgCharname(1));
-			}
-			else if (wscCmd == L"resetrep")
-			{
-				CmdResetRep(ArgCharname(1));
-			}
-			else if (wscCmd == L"setrep")
-			{
-				CmdSetRep(ArgCharname(1), ArgStr(2), ArgFloat(3));
-			}
-			else if (wscCmd == L"getrep")
-			{
-				CmdGetRep(ArgCharname(1), ArgStr(2));
-			}
-			else if (wscCmd == L"msg")
-			{
-				CmdMsg(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"msgs")
-			{
-				CmdMsgS(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"msgu")
-			{
-				CmdMsgU(ArgStrToEnd(1));
-			}
-			else if (wscCmd == L"fmsg")
-			{
-				CmdFMsg(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"fmsgs")
-			{
-				CmdFMsgS(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"fmsgu")
-			{
-				CmdFMsgU(ArgStrToEnd(1));
-			}
-			else if (wscCmd == L"enumcargo")
-			{
-				CmdEnumCargo(ArgCharname(1));
-			}
-			else if (wscCmd == L"removecargo")
-			{
-				CmdRemoveCargo(ArgCharname(1), static_cast<ushort>(ArgInt(2)), ArgInt(3));
-			}
-			else if (wscCmd == L"addcargo")
-			{
-				CmdAddCargo(ArgCharname(1), ArgStr(2), ArgInt(3), ArgInt(4));
-			}
-			else if (wscCmd == L"rename")
-			{
-				CmdRename(ArgCharname(1), ArgStr(2));
-			}
-			else if (wscCmd == L"deletechar")
-			{
-				CmdDeleteChar(ArgCharname(1));
-			}
-			else if (wscCmd == L"readcharfile")
-			{
-				CmdReadCharFile(ArgCharname(1));
-			}
-			else if (wscCmd == L"writecharfile")
-			{
-				CmdWriteCharFile(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"getplayerinfo")
-			{
-				CmdGetPlayerInfo(ArgCharname(1));
-			}
-			else if (wscCmd == L"getplayers")
-			{
-				CmdGetPlayers();
-			}
-			else if (wscCmd == L"xgetplayerinfo")
-			{
-				CmdXGetPlayerInfo(ArgCharname(1));
-			}
-			else if (wscCmd == L"xgetplayers")
-			{
-				CmdXGetPlayers();
-			}
-			else if (wscCmd == L"getplayerids")
-			{
-				CmdGetPlayerIds();
-			}
-			else if (wscCmd == L"getaccountdirname")
-			{
-				CmdGetAccountDirName(ArgCharname(1));
-			}
-			else if (wscCmd == L"getcharfilename")
-			{
-				CmdGetCharFileName(ArgCharname(1));
-			}
-			else if (wscCmd == L"savechar")
-			{
-				CmdSaveChar(ArgCharname(1));
-			}
-			else if (wscCmd == L"isonserver")
-			{
-				CmdIsOnServer(ArgCharname(1));
-			}
-			else if (wscCmd == L"moneyfixlist")
-			{
-				CmdMoneyFixList();
-			}
-			else if (wscCmd == L"serverinfo")
-			{
-				CmdServerInfo();
-			}
-			else if (wscCmd == L"getgroupmembers")
-			{
-				CmdGetGroupMembers(ArgCharname(1));
-			}
-			else if (wscCmd == L"getreservedslot")
-			{
-				CmdGetReservedSlot(ArgCharname(1));
-			}
-			else if (wscCmd == L"setreservedslot")
-			{
-				CmdSetReservedSlot(ArgCharname(1), ArgInt(2));
-			}
-			else if (wscCmd == L"setadmin")
-			{
-				CmdSetAdmin(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"getadmin")
-			{
-				CmdGetAdmin(ArgCharname(1));
-			}
-			else if (wscCmd == L"deladmin")
-			{
-				CmdDelAdmin(ArgCharname(1));
-			}
-			else if (wscCmd == L"unloadplugin")
-			{
-				CmdUnloadPlugin(ArgStrToEnd(1));
-			}
-			else if (wscCmd == L"loadplugins")
-			{
-				CmdLoadPlugins();
-			}
-			else if (wscCmd == L"reloadplugin")
-			{
-				CmdReloadPlugin(ArgStrToEnd(1));
-			}
-			else if (wscCmd == L"loadplugin")
-			{
-				CmdLoadPlugin(ArgStrToEnd(1));
-			}
-			else if (wscCmd == L"shutdown")
-			{
-				CmdShutdown();
-			}
-			else if (wscCmd == L"listplugins")
-			{
-				CmdListPlugins();
-			}
-			else if (wscCmd == L"help")
-			{
-				CmdHelp();
-			}
-			else if (wscCmd == L"move")
-			{
-				CmdMove(wscAdminName, ArgFloat(1), ArgFloat(2), ArgFloat(3));
-			}
-			else if (wscCmd == L"chase")
-			{
-				CmdChase(wscAdminName, ArgCharname(1));
-			}
-			else if (wscCmd == L"beam")
-			{
-				CmdBeam(ArgCharname(1), ArgStrToEnd(2));
-			}
-			else if (wscCmd == L"pull")
-			{
-				CmdPull(wscAdminName, ArgCharname(1));
-			}
-			else
-			{
+			if (const auto command = adminCommands.find(wscCmd); command == adminCommands.end())
 				Print("ERR unknown command");
-			}
+			else if (!HasRights(rights, command->second.rights))
+				Print("ERR No permission");
+			else
+				command->second.handler(*this);
 		}
 		if (bSocket)
 		{
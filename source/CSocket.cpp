@@ -19,6 +19,19 @@ void CSocket::DoPrint(const std::string& textIn)
 		}
 	}
 
+	if (bBuffering)
+	{
+		wscBuffer += text;
+		return;
+	}
+
+	Send(std::move(text));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CSocket::Send(std::wstring text)
+{
 	int iSndBuf = 300000; // fix: set send-buffer to this size (bytes)
 	int size = sizeof(int);
 	setsockopt(this->s, SOL_SOCKET, SO_SNDBUF, (const char*)&iSndBuf, size);
@@ -84,6 +97,23 @@ void CSocket::DoPrint(const std::string& textIn)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void CSocket::BeginBuffer()
+{
+	bBuffering = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CSocket::FlushBuffer()
+{
+	bBuffering = false;
+	if (!wscBuffer.empty())
+		Send(std::move(wscBuffer));
+	wscBuffer.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 std::wstring CSocket::GetAdminName()
 {
 	std::wstring wscReturn = L"Socket connection (";
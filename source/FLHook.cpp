@@ -8,8 +8,13 @@ struct SOCKET_CONNECTION
 {
 	std::wstring wscPending;
 	CSocket csock;
+	// Commands received after "batch", executed together on "endbatch"
+	std::optional<std::vector<std::wstring>> batch;
 };
 
+// Upper limit for the number of commands in one batch
+constexpr size_t MaxBatchCommands = 1000;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 HANDLE hProcFL = 0;
@@ -583,7 +588,35 @@ bool ProcessSocketCmd(SOCKET_CONNECTION* sc, std::wstring wscCmd)
 	}
 	else
 	{
-		if (const auto cmd = Trim(wscCmd); cmd == L"eventmode")
+		const auto cmd = Trim(wscCmd);
+		if (sc->batch)
+		{
+			if (cmd != L"endbatch")
+			{
+				// Anything past the limit only marks the batch as too long
+				if (sc->batch->size() <= MaxBatchCommands)
+					sc->batch->push_back(cmd);
+				return false;
+			}
+
+			if (sc->batch->size() > MaxBatchCommands)
+				sc->csock.Print(std::format("ERR more than {} commands in batch", MaxBatchCommands));
+			else
+			{
+				// Run the whole batch in this tick and answer with a single send
+				sc->csock.BeginBuffer();
+				for (const auto& batchCmd : *sc->batch)
+					sc->csock.ExecuteCommandString(batchCmd);
+				sc->csock.FlushBuffer();
+			}
+			sc->batch.reset();
+		}
+		else if (cmd == L"batch")
+		{
+			sc->batch.emplace();
+			sc->csock.Print("OK");
+		}
+		else if (cmd == L"eventmode")
 		{
 			if (sc->csock.rights & RIGHT_EVENTMODE)
 			{
@@ -624,6 +657,12 @@ void ProcessEvent(std::wstring text, ...)
 	}
 }
 
+bool HasEventSubscribers()
+{
+	return std::ranges::any_of(lstSockets, [](const SOCKET_CONNECTION* socket) { return socket->csock.bEventMode; }) ||
+	    PluginManager::c()->hasHooks(HookedCall::FLHook__ProcessEvent, HookStep::Before);
+}
+
 /**************************************************************************************************************
 check for pending admin commands in console or socket and execute them
 **************************************************************************************************************/
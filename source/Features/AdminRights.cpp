@@ -0,0 +1,75 @@
+#include "Features/AdminRights.hpp"
+#include "Global.hpp"
+
+std::string AdminRights::GetAdminFilePath(const std::wstring& accountDir) { return CoreGlobals::c()->accPath + wstos(accountDir) + "\\flhookadmin.ini"; }
+
+int64 AdminRights::GetFileTime(const std::string& path)
+{
+	std::error_code ec;
+	const auto time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : static_cast<int64>(time.time_since_epoch().count());
+}
+
+size_t AdminRights::Load()
+{
+	admins.clear();
+
+	std::error_code ec;
+	for (std::filesystem::directory_iterator accounts(CoreGlobals::c()->accPath, ec), end; !ec && accounts != end; accounts.increment(ec))
+	{
+		std::error_code typeError;
+		if (!accounts->is_directory(typeError))
+			continue;
+
+		const auto accountDir = accounts->path().filename().wstring();
+		const auto path = GetAdminFilePath(accountDir);
+		if (const auto fileTime = GetFileTime(path))
+			admins[ToLower(accountDir)] = {IniGetS(path, "admin", "rights", ""), fileTime};
+	}
+
+	if (ec)
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to list the account directories for admin rights: {}", ec.message()));
+
+	return admins.size();
+}
+
+void AdminRights::Refresh()
+{
+	for (auto it = admins.begin(); it != admins.end();)
+	{
+		const auto path = GetAdminFilePath(it->first);
+		const auto fileTime = GetFileTime(path);
+		if (!fileTime)
+		{
+			it = admins.erase(it);
+			continue;
+		}
+
+		if (fileTime != it->second.fileTime)
+			it->second = {IniGetS(path, "admin", "rights", ""), fileTime};
+
+		++it;
+	}
+}
+
+void AdminRights::Set(const std::wstring& accountDir, const std::string& rights)
+{
+	const auto path = GetAdminFilePath(accountDir);
+	IniWrite(path, "admin", "rights", rights);
+	admins[ToLower(accountDir)] = {rights, GetFileTime(path)};
+}
+
+void AdminRights::Remove(const std::wstring& accountDir)
+{
+	DeleteFile(GetAdminFilePath(accountDir).c_str());
+	admins.erase(ToLower(accountDir));
+}
+
+std::optional<std::string> AdminRights::Get(const std::wstring& accountDir) const
+{
+	const auto admin = admins.find(ToLower(accountDir));
+	if (admin == admins.end())
+		return std::nullopt;
+
+	return admin->second.rights;
+}
@@ -0,0 +1,467 @@
+#include "Features/CharacterIndex.hpp"
+#include "Global.hpp"
+
+#include <execution>
+
+namespace
+{
+	// The result of reading a character file. Nicknames are hashed afterwards on the main thread so that
+	// parsing does not call into the game while running in parallel.
+	struct CharacterFile
+	{
+		CharacterIndex::Character character;
+		std::string system;
+		std::string base;
+	};
+
+	std::wstring DecodeHexName(std::string_view hex)
+	{
+		std::wstring name;
+		while (hex.size() >= 4)
+		{
+			name += static_cast<wchar_t>(std::stoul(std::string(hex.substr(0, 4)), nullptr, 16));
+			hex.remove_prefix(4);
+		}
+
+		return name;
+	}
+
+	// tstamp is stored as the high and low part of a FILETIME
+	int64 FileTimeToUnix(const std::string& value)
+	{
+		const auto comma = value.find(',');
+		if (comma == std::string::npos)
+			return 0;
+
+		const uint64 high = std::stoull(value.substr(0, comma));
+		const uint64 low = std::stoull(value.substr(comma + 1));
+		const uint64 fileTime = (high << 32) | low;
+		if (!fileTime)
+			return 0;
+
+		return static_cast<int64>(fileTime / 10000000ULL) - 11644473600LL;
+	}
+
+	std::string_view Trim(std::string_view str)
+	{
+		const auto start = str.find_first_not_of(" \t\r\n");
+		if (start == std::string_view::npos)
+			return {};
+
+		const auto end = str.find_last_not_of(" \t\r\n");
+		return str.substr(start, end - start + 1);
+	}
+
+	std::optional<CharacterFile> ParseCharacterFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return std::nullopt;
+
+		std::string data((std::istreambuf_iterator(file)), std::istreambuf_iterator<char>());
+		if (data.starts_with("FLS1"))
+			data = FlcDecode(data);
+
+		CharacterFile result;
+		bool inPlayerSection = false;
+		std::string_view remaining = data;
+		try
+		{
+			while (!remaining.empty())
+			{
+				const auto lineEnd = remaining.find('\n');
+				const auto line = Trim(remaining.substr(0, lineEnd));
+				remaining = lineEnd == std::string_view::npos ? std::string_view() : remaining.substr(lineEnd + 1);
+
+				if (line.starts_with('['))
+				{
+					// Everything we need is in the [Player] section, which comes first
+					if (inPlayerSection)
+						break;
+
+					inPlayerSection = ToLower(std::string(line)) == "[player]";
+					continue;
+				}
+
+				const auto separator = line.find('=');
+				if (!inPlayerSection || separator == std::string_view::npos)
+					continue;
+
+				const auto key = ToLower(std::string(Trim(line.substr(0, separator))));
+				const auto value = std::string(Trim(line.substr(separator + 1)));
+				if (key == "name")
+					result.character.characterName = DecodeHexName(value);
+				else if (key == "money")
+					result.character.money = std::stoll(value);
+				else if (key == "system")
+					result.system = value;
+				else if (key == "base")
+					result.base = value;
+				else if (key == "tstamp")
+					result.character.lastLogin = FileTimeToUnix(value);
+			}
+		}
+		catch (const std::logic_error&)
+		{
+			// A malformed value, the file is not indexed and will be read from disk when it is needed
+			return std::nullopt;
+		}
+
+		if (result.character.characterName.empty())
+			return std::nullopt;
+
+		return result;
+	}
+
+	void ResolveNicknames(CharacterFile& file)
+	{
+		file.character.systemId = file.system.empty() ? 0 : CreateID(file.system.c_str());
+		file.character.baseId = file.base.empty() ? 0 : CreateID(file.base.c_str());
+	}
+} // namespace
+
+CharacterIndex::CharacterIndex()
+{
+	// The index is rebuilt from the character files if it is ever lost, so favour write speed over durability
+	db.exec("PRAGMA journal_mode = WAL;");
+	db.exec("PRAGMA synchronous = NORMAL;");
+
+	if (db.tableExists("characters"))
+	{
+		return;
+	}
+
+	db.exec("CREATE TABLE characters ("
+	        "nameKey TEXT NOT NULL UNIQUE PRIMARY KEY,"
+	        "characterName TEXT NOT NULL,"
+	        "accountDir TEXT NOT NULL,"
+	        "charFile TEXT NOT NULL,"
+	        "money INTEGER NOT NULL,"
+	        "systemId INTEGER NOT NULL,"
+	        "baseId INTEGER NOT NULL,"
+	        "lastLogin INTEGER NOT NULL,"
+	        "fileTime INTEGER NOT NULL);");
+
+	db.exec("CREATE INDEX IDX_accountDir ON characters (accountDir, charFile);");
+}
+
+std::string CharacterIndex::GetCharacterPath(const std::wstring& accountDir, const std::wstring& charFile)
+{
+	return CoreGlobals::c()->accPath + wstos(accountDir) + "\\" + wstos(charFile) + ".fl";
+}
+
+int64 CharacterIndex::GetFileTime(const std::string& path)
+{
+	std::error_code ec;
+	const auto time = std::filesystem::last_write_time(path, ec);
+	return ec ? 0 : static_cast<int64>(time.time_since_epoch().count());
+}
+
+std::optional<CharacterIndex::Character> CharacterIndex::ReadCharacterFile(const std::wstring& accountDir, const std::wstring& charFile)
+{
+	const auto path = GetCharacterPath(accountDir, charFile);
+	auto file = ParseCharacterFile(path);
+	if (!file)
+		return std::nullopt;
+
+	ResolveNicknames(*file);
+	file->character.accountDir = accountDir;
+	file->character.charFile = charFile;
+	file->character.fileTime = GetFileTime(path);
+	return file->character;
+}
+
+std::optional<std::wstring> CharacterIndex::ReadCharacterName(const std::string& path)
+{
+	auto file = ParseCharacterFile(path);
+	if (!file)
+		return std::nullopt;
+
+	return std::move(file->character.characterName);
+}
+
+void CharacterIndex::Store(const Character& character)
+{
+	// A character file can only belong to one name, drop whatever was stored for it before
+	SQLite::Statement removeFile(db, "DELETE FROM characters WHERE accountDir = ? AND charFile = ?;");
+	removeFile.bind(1, wstos(character.accountDir));
+	removeFile.bind(2, wstos(character.charFile));
+	removeFile.exec();
+
+	SQLite::Statement insert(db,
+	    "INSERT OR REPLACE INTO characters (nameKey, characterName, accountDir, charFile, money, systemId, baseId, lastLogin, fileTime) "
+	    "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?);");
+	insert.bind(1, wstos(ToLower(character.characterName)));
+	insert.bind(2, wstos(character.characterName));
+	insert.bind(3, wstos(character.accountDir));
+	insert.bind(4, wstos(character.charFile));
+	insert.bind(5, character.money);
+	insert.bind(6, static_cast<int64>(character.systemId));
+	insert.bind(7, static_cast<int64>(character.baseId));
+	insert.bind(8, character.lastLogin);
+	insert.bind(9, character.fileTime);
+	insert.exec();
+}
+
+void CharacterIndex::Build()
+{
+	try
+	{
+		Flush();
+
+		// The write time of every indexed file, entries that are still in the map afterwards have no file anymore
+		std::map<std::pair<std::wstring, std::wstring>, int64> indexed;
+		SQLite::Statement query(db, "SELECT accountDir, charFile, fileTime FROM characters;");
+		while (query.executeStep())
+			indexed[{stows(query.getColumn(0).getString()), stows(query.getColumn(1).getString())}] = query.getColumn(2).getInt64();
+
+		std::vector<std::pair<std::wstring, std::wstring>> files;
+		size_t fileCount = 0;
+		bool listingFailed = false;
+		std::error_code accountsError;
+		for (std::filesystem::directory_iterator accounts(CoreGlobals::c()->accPath, accountsError), accountsEnd;
+		     !accountsError && accounts != accountsEnd; accounts.increment(accountsError))
+		{
+			std::error_code typeError;
+			if (!accounts->is_directory(typeError))
+			{
+				listingFailed |= static_cast<bool>(typeError);
+				continue;
+			}
+
+			std::error_code filesError;
+			for (std::filesystem::directory_iterator charFiles(accounts->path(), filesError), filesEnd;
+			     !filesError && charFiles != filesEnd; charFiles.increment(filesError))
+			{
+				const auto& charFile = *charFiles;
+				if (charFile.path().extension() != ".fl")
+					continue;
+
+				fileCount++;
+				std::pair file {accounts->path().filename().wstring(), charFile.path().stem().wstring()};
+				// The directory listing already carries the write time on Windows, so unchanged files cost no extra file system call
+				std::error_code timeError;
+				const auto fileTime = charFile.last_write_time(timeError);
+				const auto entry = indexed.find(file);
+				const bool changed =
+				    timeError || entry == indexed.end() || entry->second != static_cast<int64>(fileTime.time_since_epoch().count());
+				if (entry != indexed.end())
+					indexed.erase(entry);
+
+				if (changed)
+					files.emplace_back(std::move(file));
+			}
+			listingFailed |= static_cast<bool>(filesError);
+		}
+		listingFailed |= static_cast<bool>(accountsError);
+
+		// A file that could not be listed is not known to be deleted, so nothing is dropped this time
+		if (listingFailed)
+		{
+			AddLog(LogType::Normal, LogLevel::Warn, "Unable to list every character file, entries of files that were not seen are kept");
+			indexed.clear();
+		}
+
+		if (files.empty() && indexed.empty())
+			return;
+
+		Console::ConInfo(std::format("Updating the character index, {} of {} character files changed", files.size(), fileCount));
+
+		std::vector<std::optional<CharacterFile>> results(files.size());
+		std::transform(std::execution::par, files.begin(), files.end(), results.begin(), [](const auto& file) {
+			const auto path = GetCharacterPath(file.first, file.second);
+			auto result = ParseCharacterFile(path);
+			if (result)
+			{
+				result->character.accountDir = file.first;
+				result->character.charFile = file.second;
+				result->character.fileTime = GetFileTime(path);
+			}
+			return result;
+		});
+
+		SQLite::Transaction transaction(db);
+		SQLite::Statement removeFile(db, "DELETE FROM characters WHERE accountDir = ? AND charFile = ?;");
+		for (const auto& [file, fileTime] : indexed)
+		{
+			removeFile.bind(1, wstos(file.first));
+			removeFile.bind(2, wstos(file.second));
+			removeFile.exec();
+			removeFile.reset();
+		}
+
+		int updated = 0;
+		for (auto& result : results)
+		{
+			if (!result)
+				continue;
+
+			ResolveNicknames(*result);
+			Store(result->character);
+			updated++;
+		}
+		transaction.commit();
+
+		Console::ConInfo(std::format("Indexed {} character files, dropped {} deleted ones", updated, indexed.size()));
+	}
+	catch (SQLite::Exception& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to build the character index: {}", ex.getErrorStr()));
+	}
+	catch (std::filesystem::filesystem_error& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to build the character index: {}", ex.what()));
+	}
+}
+
+void CharacterIndex::UpdateFromClient(ClientId client)
+{
+	const auto name = Hk::Client::GetCharacterNameByID(client);
+	const auto charFile = Hk::Client::GetCharFileName(client);
+	const auto cash = Hk::Player::GetCash(client);
+	const auto system = Hk::Player::GetSystem(client);
+	if (name.has_error() || charFile.has_error() || cash.has_error() || system.has_error())
+		return;
+
+	Character character;
+	character.characterName = name.value();
+	character.accountDir = Hk::Client::GetAccountDirName(Hk::Client::GetAccountByClientID(client));
+	character.charFile = charFile.value();
+	character.money = cash.value();
+	character.systemId = system.value();
+	character.baseId = Hk::Player::GetCurrentBase(client).value_or(0);
+	character.lastLogin = Hk::Time::GetUnixSeconds();
+	character.fileTime = GetFileTime(GetCharacterPath(character.accountDir, character.charFile));
+
+	// A character saved several times in one tick only needs its last state written
+	pendingUpdates[character.accountDir + L"\\" + character.charFile] = std::move(character);
+}
+
+void CharacterIndex::Flush()
+{
+	if (pendingUpdates.empty())
+		return;
+
+	try
+	{
+		SQLite::Transaction transaction(db);
+		for (const auto& [file, character] : pendingUpdates)
+			Store(character);
+		transaction.commit();
+	}
+	catch (SQLite::Exception& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to update the character index: {}", ex.getErrorStr()));
+	}
+
+	pendingUpdates.clear();
+}
+
+void CharacterIndex::UpdateFromFile(const std::wstring& accountDir, const std::wstring& charFile)
+{
+	Flush();
+
+	const auto character = ReadCharacterFile(accountDir, charFile);
+	if (!character)
+		return;
+
+	try
+	{
+		Store(character.value());
+	}
+	catch (SQLite::Exception& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to update the character index: {}", ex.getErrorStr()));
+	}
+}
+
+void CharacterIndex::RemoveCharacter(const std::wstring& characterName)
+{
+	// A queued update must not bring the character back afterwards
+	Flush();
+
+	try
+	{
+		SQLite::Statement remove(db, "DELETE FROM characters WHERE nameKey = ?;");
+		remove.bind(1, wstos(ToLower(characterName)));
+		remove.exec();
+	}
+	catch (SQLite::Exception& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to update the character index: {}", ex.getErrorStr()));
+	}
+}
+
+namespace
+{
+	CharacterIndex::Character ReadRow(const SQLite::Statement& query)
+	{
+		CharacterIndex::Character character;
+		character.characterName = stows(query.getColumn(0).getString());
+		character.accountDir = stows(query.getColumn(1).getString());
+		character.charFile = stows(query.getColumn(2).getString());
+		character.money = query.getColumn(3).getInt64();
+		character.systemId = static_cast<uint>(query.getColumn(4).getInt64());
+		character.baseId = static_cast<uint>(query.getColumn(5).getInt64());
+		character.lastLogin = query.getColumn(6).getInt64();
+		character.fileTime = query.getColumn(7).getInt64();
+		return character;
+	}
+} // namespace
+
+cpp::result<CharacterIndex::Character, Error> CharacterIndex::GetCharacter(const std::wstring& characterName)
+{
+	Flush();
+
+	std::optional<Character> character;
+	try
+	{
+		SQLite::Statement query(db,
+		    "SELECT characterName, accountDir, charFile, money, systemId, baseId, lastLogin, fileTime FROM characters WHERE nameKey = ?;");
+		query.bind(1, wstos(ToLower(characterName)));
+		if (query.executeStep())
+			character = ReadRow(query);
+	}
+	catch (SQLite::Exception& ex)
+	{
+		AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to read the character index: {}", ex.getErrorStr()));
+	}
+
+	if (!character)
+		return cpp::fail(Error::CharacterDoesNotExist);
+
+	// Validate the entry against the file, it might have been edited or deleted by something other than the server
+	const auto fileTime = GetFileTime(GetCharacterPath(character->accountDir, character->charFile));
+	if (!fileTime)
+	{
+		RemoveCharacter(characterName);
+		return cpp::fail(Error::CharacterDoesNotExist);
+	}
+
+	if (fileTime != character->fileTime)
+	{
+		const auto accountDir = character->accountDir;
+		const auto charFile = character->charFile;
+		character = ReadCharacterFile(accountDir, charFile);
+		if (!character)
+		{
+			RemoveCharacter(characterName);
+			return cpp::fail(Error::CharacterDoesNotExist);
+		}
+
+		try
+		{
+			Store(character.value());
+		}
+		catch (SQLite::Exception& ex)
+		{
+			AddLog(LogType::Normal, LogLevel::Err, std::format("Unable to update the character index: {}", ex.getErrorStr()));
+		}
+
+		// The file now belongs to a different name
+		if (ToLower(character->characterName) != ToLower(characterName))
+			return cpp::fail(Error::CharacterDoesNotExist);
+	}
+
+	return character.value();
+}
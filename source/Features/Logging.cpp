@@ -166,7 +166,7 @@ bool AddCheaterLog(const std::variant<uint, std::wstring>& player, const std::st
 	std::wstring wscHostName = L"???";
 	std::wstring wscIp = L"???";
 
-	wscHostName = ClientInfo[client].wscHostname;
+	wscHostName = ClientInfoCold[client].wscHostname;
 	wscIp = Hk::Admin::GetPlayerIP(client);
 
 	const std::wstring wscCharacterName = Hk::Client::GetCharacterNameByID(client).value();
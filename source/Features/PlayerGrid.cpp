@@ -0,0 +1,158 @@
+#include "Features/PlayerGrid.hpp"
+#include "Global.hpp"
+
+int PlayerGrid::GetCellCoordinate(float value) { return static_cast<int>(std::floor(value / CellSize)); }
+
+uint64 PlayerGrid::GetCellKey(int x, int y, int z)
+{
+	// SPObjUpdate kicks anyone further than 1e7 out, so 21 bits per axis are plenty
+	constexpr uint64 mask = (1ull << 21) - 1;
+	return ((static_cast<uint64>(x) & mask) << 42) | ((static_cast<uint64>(y) & mask) << 21) | (static_cast<uint64>(z) & mask);
+}
+
+void PlayerGrid::Unlink(ClientId client)
+{
+	const auto& entry = entries[client];
+	if (!entry.system)
+		return;
+
+	const auto system = systems.find(entry.system);
+	if (system == systems.end())
+		return;
+
+	const auto cell = system->second.find(entry.cell);
+	if (cell == system->second.end())
+		return;
+
+	// Order within a cell does not matter, so swap with the last one instead of shifting
+	auto& clients = cell->second;
+	if (const auto it = std::ranges::find(clients, client); it != clients.end())
+	{
+		*it = clients.back();
+		clients.pop_back();
+	}
+
+	if (clients.empty())
+	{
+		system->second.erase(cell);
+		if (system->second.empty())
+			systems.erase(system);
+	}
+}
+
+void PlayerGrid::Update(ClientId client, uint system, const Vector& position)
+{
+	if (client < 1 || client > MaxClientId)
+		return;
+
+	if (!system)
+	{
+		Remove(client);
+		return;
+	}
+
+	auto& entry = entries[client];
+	const uint64 cell = GetCellKey(GetCellCoordinate(position.x), GetCellCoordinate(position.y), GetCellCoordinate(position.z));
+
+	// Most updates do not leave the cell, those only need the position stored
+	if (entry.system != system || entry.cell != cell)
+	{
+		Unlink(client);
+		systems[system][cell].push_back(client);
+		entry.system = system;
+		entry.cell = cell;
+	}
+
+	entry.position = position;
+}
+
+void PlayerGrid::UpdateFromShip(ClientId client)
+{
+	if (!Hk::Client::IsValidClientID(client))
+		return;
+
+	uint ship = 0;
+	pub::Player::GetShip(client, ship);
+	if (!ship)
+	{
+		Remove(client);
+		return;
+	}
+
+	uint system = 0;
+	pub::Player::GetSystem(client, system);
+
+	Vector position;
+	Matrix orientation;
+	pub::SpaceObj::GetLocation(ship, position, orientation);
+
+	Update(client, system, position);
+}
+
+void PlayerGrid::Remove(ClientId client)
+{
+	if (client < 1 || client > MaxClientId)
+		return;
+
+	Unlink(client);
+	entries[client] = {};
+}
+
+std::vector<uint> PlayerGrid::QueryRadius(uint system, const Vector& position, float radius) const
+{
+	std::vector<uint> result;
+
+	const auto grid = systems.find(system);
+	if (grid == systems.end() || radius < 0.0f)
+		return result;
+
+	const float radiusSquared = radius * radius;
+	const auto addIfInRange = [&](const std::vector<uint>& clients) {
+		for (const uint client : clients)
+		{
+			const auto& pos = entries[client].position;
+			const float dx = pos.x - position.x;
+			const float dy = pos.y - position.y;
+			const float dz = pos.z - position.z;
+			if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+				result.push_back(client);
+		}
+	};
+
+	// Every ship is within 1e7 of the origin, anything larger than that covers the whole system
+	const float clampedRadius = std::min(radius, 2e7f);
+	const int minX = GetCellCoordinate(position.x - clampedRadius), maxX = GetCellCoordinate(position.x + clampedRadius);
+	const int minY = GetCellCoordinate(position.y - clampedRadius), maxY = GetCellCoordinate(position.y + clampedRadius);
+	const int minZ = GetCellCoordinate(position.z - clampedRadius), maxZ = GetCellCoordinate(position.z + clampedRadius);
+
+	// With a large radius there are more cells to probe than occupied ones, walk the occupied ones instead
+	const uint64 cellCount = static_cast<uint64>(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+	if (cellCount >= grid->second.size())
+	{
+		for (const auto& [cell, clients] : grid->second)
+			addIfInRange(clients);
+		return result;
+	}
+
+	for (int x = minX; x <= maxX; x++)
+	{
+		for (int y = minY; y <= maxY; y++)
+		{
+			for (int z = minZ; z <= maxZ; z++)
+			{
+				if (const auto cell = grid->second.find(GetCellKey(x, y, z)); cell != grid->second.end())
+					addIfInRange(cell->second);
+			}
+		}
+	}
+
+	return result;
+}
+
+std::optional<Vector> PlayerGrid::GetPosition(ClientId client) const
+{
+	if (client < 1 || client > MaxClientId || !entries[client].system)
+		return std::nullopt;
+
+	return entries[client].position;
+}
@@ -42,6 +42,7 @@ void PluginManager::clearData(bool free)
 				FreeLibrary(p->dll);
 	}
 	plugins_.clear();
+	UserCmd_InvalidateIndex();
 
 	for (auto& p : pluginHooks_)
 		p.clear();
@@ -87,6 +88,7 @@ cpp::result<std::wstring, Error> PluginManager::unload(const std::string& name)
 	}
 
 	plugins_.erase(pluginIterator);
+	UserCmd_InvalidateIndex();
 
 	FreeLibrary(dllAddr);
 	return unloadedPluginDll;
@@ -226,6 +228,7 @@ void PluginManager::load(const std::wstring& fileName, CCmds* adminInterface, bo
 	plugins_.emplace_back(plugin);
 
 	std::ranges::sort(plugins_, [](const std::shared_ptr<PluginData> a, std::shared_ptr<PluginData> b) { return a->name < b->name; });
+	UserCmd_InvalidateIndex();
 
 	adminInterface->Print(std::format("Plugin {} loaded ({})", plugin->shortName, wstos(plugin->dllName)));
 }
@@ -0,0 +1,107 @@
+#include "Features/SaveScheduler.hpp"
+#include "Global.hpp"
+
+// The game keeps the last character loaded while the client sits in the character select menu, so a pending save can still be
+// written there. Only a client without any loaded character has nothing to save.
+static bool HasLoadedCharacter(ClientId client)
+{
+	return Hk::Client::IsValidClientID(client) && Players.GetActiveCharacterName(client);
+}
+
+void SaveScheduler::QueueSave(ClientId client)
+{
+	if (client < 1 || client > MaxClientId)
+		return;
+
+	auto& state = saveStates[client];
+	if (state.queued)
+		return;
+
+	state.queued = true;
+	saveQueue.push_back(client);
+}
+
+cpp::result<void, Error> SaveScheduler::SaveNow(const std::variant<uint, std::wstring>& player)
+{
+	// Hk::Player::SaveChar calls MarkSaved, which drops any pending save for this client
+	return Hk::Player::SaveChar(player);
+}
+
+void SaveScheduler::FlushClient(ClientId client)
+{
+	if (!IsPending(client))
+		return;
+
+	if (!HasLoadedCharacter(client))
+	{
+		saveStates[client].queued = false;
+		return;
+	}
+
+	SaveNow(client);
+}
+
+void SaveScheduler::MarkSaved(ClientId client)
+{
+	if (client < 1 || client > MaxClientId)
+		return;
+
+	// The queue entry is left in place and skipped once it reaches the front
+	saveStates[client].queued = false;
+	saveStates[client].lastSave = Hk::Time::GetUnixMiliseconds();
+}
+
+void SaveScheduler::ProcessQueue()
+{
+	if (saveQueue.empty())
+		return;
+
+	const auto* config = FLHookConfig::c();
+	const auto budget = std::chrono::milliseconds(config->general.characterSaveBudget);
+	const auto start = std::chrono::steady_clock::now();
+	const mstime now = Hk::Time::GetUnixMiliseconds();
+
+	// Only look at each entry once per tick, entries that are not due yet are moved to the back
+	size_t remaining = saveQueue.size();
+	bool savedAny = false;
+	while (remaining-- && !saveQueue.empty())
+	{
+		if (savedAny && std::chrono::steady_clock::now() - start >= budget)
+			break;
+
+		const uint client = saveQueue.front();
+		saveQueue.pop_front();
+
+		auto& state = saveStates[client];
+		if (!state.queued)
+			continue;
+
+		if (now - state.lastSave < config->general.characterSaveInterval)
+		{
+			saveQueue.push_back(client);
+			continue;
+		}
+
+		if (!HasLoadedCharacter(client))
+		{
+			state.queued = false;
+			continue;
+		}
+
+		SaveNow(client);
+		savedAny = true;
+	}
+}
+
+bool SaveScheduler::IsPending(ClientId client) const
+{
+	if (client < 1 || client > MaxClientId)
+		return false;
+
+	return saveStates[client].queued;
+}
+
+size_t SaveScheduler::GetPendingCount() const
+{
+	return std::ranges::count_if(saveStates, [](const SaveState& state) { return state.queued; });
+}
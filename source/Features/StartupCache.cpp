@@ -1,4 +1,5 @@
 #include "Global.hpp"
+#include "Features/CharacterIndex.hpp"
 
 namespace StartupCache
 {
@@ -9,15 +10,103 @@ namespace StartupCache
 	typedef int(__stdcall* _ReadCharacterName)(const char* filename, st6::wstring* str);
 	_ReadCharacterName ReadCharName;
 
-	// map of acc_char_path to char name
-	static std::map<std::string, std::wstring> cache;
-
 	static std::string scBaseAcctPath;
 
 	// length of the user data path + accts\multiplayer to remove so that
 	// we can search only for the acc_char_path
 	static int acc_path_prefix_length = 0;
 
+	struct NameInfo
+	{
+		char acc_path[27]; // accdir(11)/charfile(11).fl + terminator
+		wchar_t name[25];  // max name is 24 chars + terminator
+	};
+
+	// namecache.bin is laid out as the header, the hash buckets and then the records. Records are only ever appended
+	// so the buckets can stay in place and a save only has to write what was added since the last start.
+	struct CacheHeader
+	{
+		char magic[4];
+		uint version;
+		uint recordSize;
+		uint recordCount;
+		uint bucketCount;
+	};
+
+	constexpr char CacheMagic[4] = {'F', 'L', 'N', 'C'};
+	constexpr uint CacheVersion = 1;
+	constexpr uint MinBucketCount = 1024;
+
+	// Buckets hold the record index + 1 so that 0 marks an empty bucket
+	constexpr uint EmptyBucket = 0;
+
+	static HANDLE cacheFile = INVALID_HANDLE_VALUE;
+	static HANDLE cacheMapping = nullptr;
+	static char* cacheView = nullptr;
+
+	// Names that were not in the mapped cache, written out when the server has finished starting up
+	static std::unordered_map<std::string, std::wstring> newNames;
+
+	static CacheHeader* GetHeader() { return reinterpret_cast<CacheHeader*>(cacheView); }
+	static uint* GetBuckets() { return reinterpret_cast<uint*>(cacheView + sizeof(CacheHeader)); }
+	static NameInfo* GetRecords() { return reinterpret_cast<NameInfo*>(cacheView + sizeof(CacheHeader) + GetHeader()->bucketCount * sizeof(uint)); }
+
+	static size_t GetCacheSize(uint bucketCount, uint recordCount)
+	{
+		return sizeof(CacheHeader) + bucketCount * sizeof(uint) + recordCount * sizeof(NameInfo);
+	}
+
+	// FNV-1a
+	static uint HashPath(std::string_view path)
+	{
+		uint hash = 2166136261u;
+		for (const char c : path)
+		{
+			hash ^= static_cast<uchar>(c);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	static void InsertBucket(uint* buckets, uint bucketCount, const NameInfo* records, uint record)
+	{
+		uint bucket = HashPath(records[record].acc_path) & (bucketCount - 1);
+		while (buckets[bucket] != EmptyBucket)
+			bucket = (bucket + 1) & (bucketCount - 1);
+
+		buckets[bucket] = record + 1;
+	}
+
+	static const NameInfo* FindRecord(std::string_view accPath)
+	{
+		if (!cacheView)
+			return nullptr;
+
+		const auto* header = GetHeader();
+		const auto* buckets = GetBuckets();
+		const auto* records = GetRecords();
+
+		uint bucket = HashPath(accPath) & (header->bucketCount - 1);
+		while (buckets[bucket] != EmptyBucket)
+		{
+			const auto& record = records[buckets[bucket] - 1];
+			if (accPath == std::string_view(record.acc_path, strnlen(record.acc_path, sizeof(record.acc_path))))
+				return &record;
+
+			bucket = (bucket + 1) & (header->bucketCount - 1);
+		}
+
+		return nullptr;
+	}
+
+	static NameInfo MakeRecord(const std::string& accPath, const std::wstring& name)
+	{
+		NameInfo ni {};
+		strncpy_s(ni.acc_path, accPath.c_str(), _TRUNCATE);
+		wcsncpy_s(ni.name, name.c_str(), _TRUNCATE);
+		return ni;
+	}
+
 	// A fast alternative to the built in read character name function in server.dll
 	static int __stdcall Cb_ReadCharacterName(const char* filename, st6::wstring* str)
 	{
@@ -26,7 +115,14 @@ namespace StartupCache
 		// If this account/charfile can be found in the character return
 		// then name immediately.
 		std::string acc_path(&filename[acc_path_prefix_length]);
-		if (auto i = cache.find(acc_path); i != cache.end())
+		if (const auto* record = FindRecord(acc_path))
+		{
+			const std::wstring name(record->name, wcsnlen(record->name, std::size(record->name)));
+			*str = st6::wstring((ushort*)name.c_str());
+			return 1;
+		}
+
+		if (const auto i = newNames.find(acc_path); i != newNames.end())
 		{
 			*str = st6::wstring((ushort*)i->second.c_str());
 			return 1;
@@ -35,65 +131,294 @@ namespace StartupCache
 		// Otherwise use the original FL function to load the char name
 		// and cache the result and report that this is an uncached file
 		ReadCharName(filename, str);
-		cache[acc_path] = std::wstring((wchar_t*)str->c_str());
+
+		// Paths that do not fit into a record are simply never cached
+		if (acc_path.size() < sizeof(NameInfo::acc_path))
+			newNames[acc_path] = std::wstring((wchar_t*)str->c_str());
+
 		return 1;
 	}
 
-	struct NameInfo
+	static void CloseCache()
 	{
-		char acc_path[27]; // accdir(11)/charfile(11).fl + terminator
-		wchar_t name[25];  // max name is 24 chars + terminator
-	};
+		if (cacheView)
+			UnmapViewOfFile(cacheView);
+		if (cacheMapping)
+			CloseHandle(cacheMapping);
+		if (cacheFile != INVALID_HANDLE_VALUE)
+			CloseHandle(cacheFile);
+
+		cacheView = nullptr;
+		cacheMapping = nullptr;
+		cacheFile = INVALID_HANDLE_VALUE;
+	}
+
+	static bool MapCache(size_t size)
+	{
+		cacheMapping = CreateFileMapping(cacheFile, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), nullptr);
+		if (!cacheMapping)
+			return false;
+
+		cacheView = static_cast<char*>(MapViewOfFile(cacheMapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+		return cacheView != nullptr;
+	}
+
+	// Reads a cache written by older versions, which was just a list of records
+	static void LoadLegacyCache(const std::string& path)
+	{
+		FILE* file;
+		fopen_s(&file, path.c_str(), "rb");
+		if (!file)
+			return;
+
+		NameInfo ni {};
+		while (fread(&ni, sizeof(NameInfo), 1, file))
+		{
+			newNames[std::string(ni.acc_path, strnlen(ni.acc_path, sizeof(ni.acc_path)))] = std::wstring(ni.name, wcsnlen(ni.name, std::size(ni.name)));
+		}
+		fclose(file);
+	}
 
 	static void LoadCache()
 	{
-		// Open the name cache file and load it into memory.
+		// Map the name cache file into memory.
 		std::string scPath = scBaseAcctPath + "namecache.bin";
 
 		Console::ConInfo("Loading character name cache");
-		FILE* file;
-		fopen_s(&file, scPath.c_str(), "rb");
-		if (file)
+
+		cacheFile = CreateFile(scPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (cacheFile == INVALID_HANDLE_VALUE)
+		{
+			Console::ConInfo("No character name cache found");
+			return;
+		}
+
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(cacheFile, &fileSize);
+		const auto size = static_cast<size_t>(fileSize.QuadPart);
+
+		CacheHeader header {};
+		DWORD read = 0;
+		const bool hasHeader = ReadFile(cacheFile, &header, sizeof(header), &read, nullptr) && read == sizeof(header);
+		const bool hasMagic = read >= sizeof(CacheMagic) && !memcmp(header.magic, CacheMagic, sizeof(CacheMagic));
+		const bool valid = hasHeader && hasMagic && header.version == CacheVersion &&
+		    header.recordSize == sizeof(NameInfo) && header.bucketCount >= MinBucketCount && std::has_single_bit(header.bucketCount) &&
+		    header.recordCount < header.bucketCount && size == GetCacheSize(header.bucketCount, header.recordCount);
+
+		if (!valid)
 		{
-			NameInfo ni {};
-			while (fread(&ni, sizeof(NameInfo), 1, file))
+			CloseCache();
+
+			// A file with the magic is never a legacy one, even if its size happens to fit, e.g. a torn append or a newer version
+			if (!hasMagic && size % sizeof(NameInfo) == 0)
+			{
+				LoadLegacyCache(scPath);
+				Console::ConInfo(std::format("Converting {} names from the old name cache format", newNames.size()));
+			}
+			else
 			{
-				std::string acc_path(ni.acc_path);
-				std::wstring name(ni.name);
-				cache[acc_path] = name;
+				Console::ConWarn("The character name cache is invalid and will be rebuilt");
 			}
+			return;
+		}
+
+		if (!MapCache(size))
+		{
+			Console::ConErr("Mapping the character name cache failed");
+			CloseCache();
+			return;
+		}
+
+		// FindRecord trusts the buckets, so check once that each refers to a record and that the probing always reaches an empty one
+		const auto* buckets = GetBuckets();
+		uint usedBuckets = 0;
+		for (uint bucket = 0; bucket < header.bucketCount; bucket++)
+		{
+			if (buckets[bucket] > header.recordCount)
+			{
+				usedBuckets = UINT_MAX;
+				break;
+			}
+			if (buckets[bucket] != EmptyBucket)
+				usedBuckets++;
+		}
+
+		if (usedBuckets > header.recordCount)
+		{
+			CloseCache();
+			Console::ConWarn("The character name cache is invalid and will be rebuilt");
+			return;
+		}
+
+		Console::ConInfo(std::format("Loaded {} names", header.recordCount));
+	}
+
+	// Writes the whole cache from scratch, used when there is no valid file yet or the hash table has to grow
+	static void RewriteCache(const std::string& path)
+	{
+		std::vector<NameInfo> records;
+		if (cacheView)
+			records.assign(GetRecords(), GetRecords() + GetHeader()->recordCount);
+		CloseCache();
+
+		for (const auto& [charPath, charName] : newNames)
+			records.emplace_back(MakeRecord(charPath, charName));
+
+		const auto recordCount = static_cast<uint>(records.size());
+		const uint bucketCount = std::max(MinBucketCount, std::bit_ceil(recordCount * 2));
+
+		std::vector<char> data(GetCacheSize(bucketCount, recordCount));
+		auto* header = reinterpret_cast<CacheHeader*>(data.data());
+		memcpy(header->magic, CacheMagic, sizeof(CacheMagic));
+		header->version = CacheVersion;
+		header->recordSize = sizeof(NameInfo);
+		header->recordCount = recordCount;
+		header->bucketCount = bucketCount;
+
+		auto* buckets = reinterpret_cast<uint*>(data.data() + sizeof(CacheHeader));
+		auto* recordData = reinterpret_cast<NameInfo*>(data.data() + sizeof(CacheHeader) + bucketCount * sizeof(uint));
+		std::ranges::copy(records, recordData);
+		for (uint i = 0; i < recordCount; i++)
+			InsertBucket(buckets, bucketCount, recordData, i);
+
+		FILE* file;
+		fopen_s(&file, path.c_str(), "wb");
+		if (!file || fwrite(data.data(), data.size(), 1, file) != 1)
+			Console::ConErr("Saving character name cache failed");
+		if (file)
 			fclose(file);
+
+		Console::ConInfo(std::format("Saved {} names", recordCount));
+	}
+
+	// Appends the new names to the mapped cache, only the new records, their buckets and the header are written
+	static void AppendToCache()
+	{
+		const uint oldCount = GetHeader()->recordCount;
+		const uint bucketCount = GetHeader()->bucketCount;
+		const uint newCount = oldCount + static_cast<uint>(newNames.size());
+
+		UnmapViewOfFile(cacheView);
+		CloseHandle(cacheMapping);
+		cacheView = nullptr;
+		cacheMapping = nullptr;
+
+		// Mapping beyond the end of the file grows it
+		if (!MapCache(GetCacheSize(bucketCount, newCount)))
+		{
+			Console::ConErr("Saving character name cache failed");
+			return;
 		}
-		Console::ConInfo(std::format("Loaded {} names", cache.size()));
+
+		auto* buckets = GetBuckets();
+		auto* records = GetRecords();
+		uint record = oldCount;
+		for (const auto& [charPath, charName] : newNames)
+		{
+			records[record] = MakeRecord(charPath, charName);
+			InsertBucket(buckets, bucketCount, records, record++);
+		}
+		GetHeader()->recordCount = newCount;
+
+		FlushViewOfFile(cacheView, 0);
+		Console::ConInfo(std::format("Added {} names to the character name cache", newNames.size()));
 	}
 
 	static void SaveCache()
 	{
-		// Save the name cache file
 		std::string scPath = scBaseAcctPath + "namecache.bin";
 
-		FILE* file;
-		fopen_s(&file, scPath.c_str(), "wb");
-		if (file)
+		if (newNames.empty() && cacheView)
+		{
+			Console::ConInfo("Character name cache is up to date");
+		}
+		else if (cacheView && (GetHeader()->recordCount + newNames.size()) * 2 <= GetHeader()->bucketCount)
+		{
+			AppendToCache();
+		}
+		else
 		{
 			Console::ConInfo("Saving character name cache");
-			for (const auto& [charPath, charName] : cache)
+			RewriteCache(scPath);
+		}
+
+		CloseCache();
+		newNames.clear();
+	}
+
+	// Reads the names of every character file missing from the cache on a pool of worker threads before the server
+	// starts asking for them, so that the ReadCharacterName hook can answer every request from memory
+	static void Prewarm()
+	{
+		std::vector<std::string> paths;
+		std::error_code ec;
+		for (const auto& account : std::filesystem::directory_iterator(scBaseAcctPath, ec))
+		{
+			if (!account.is_directory())
+				continue;
+
+			for (const auto& charFile : std::filesystem::directory_iterator(account.path(), ec))
+			{
+				if (charFile.path().extension() != ".fl")
+					continue;
+
+				std::string accPath = account.path().filename().string() + "\\" + charFile.path().filename().string();
+				if (accPath.size() < sizeof(NameInfo::acc_path) && !FindRecord(accPath) && !newNames.contains(accPath))
+					paths.emplace_back(std::move(accPath));
+			}
+		}
+
+		if (paths.empty())
+			return;
+
+		const uint workerCount = std::max(1u, std::thread::hardware_concurrency());
+		Console::ConInfo(std::format("Prewarming {} uncached character names on {} threads", paths.size(), workerCount));
+
+		const auto start = std::chrono::steady_clock::now();
+		std::vector<std::optional<std::wstring>> names(paths.size());
+		std::atomic<size_t> next = 0;
+		std::atomic<size_t> processed = 0;
+		{
+			std::vector<std::jthread> workers;
+			for (uint i = 0; i < workerCount; i++)
 			{
-				NameInfo ni {};
-				memset(&ni, 0, sizeof(ni));
-				strncpy_s(ni.acc_path, 27, charPath.c_str(), charPath.size());
-				wcsncpy_s(ni.name, 25, charName.c_str(), charName.size());
-				if (!fwrite(&ni, sizeof(NameInfo), 1, file))
+				workers.emplace_back([&] {
+					for (size_t file; (file = next++) < paths.size();)
+					{
+						names[file] = CharacterIndex::ReadCharacterName(scBaseAcctPath + paths[file]);
+						++processed;
+					}
+				});
+			}
+
+			// The console is not thread safe, so progress is only reported from here
+			auto lastReport = start;
+			while (processed < paths.size())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				if (const auto now = std::chrono::steady_clock::now(); now - lastReport >= std::chrono::seconds(1))
 				{
-					Console::ConErr("Saving character name cache failed");
-					break;
+					Console::ConInfo(std::format("Prewarmed {}/{} character names", processed.load(), paths.size()));
+					lastReport = now;
 				}
 			}
-			fclose(file);
-			Console::ConInfo(std::format("Saved {} names", cache.size()));
 		}
 
-		cache.clear();
+		size_t prewarmed = 0;
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			if (!names[i])
+				continue;
+
+			newNames[paths[i]] = std::move(names[i].value());
+			prewarmed++;
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		Console::ConInfo(std::format("Prewarmed {} character names in {}ms ({:.0f} files/s)",
+		    prewarmed,
+		    elapsed,
+		    static_cast<double>(paths.size()) * 1000.0 / static_cast<double>(std::max(elapsed, 1LL))));
 	}
 
 	// Call from Startup
@@ -121,6 +446,7 @@ namespace StartupCache
 
 		// Load the cache
 		LoadCache();
+		Prewarm();
 	}
 
 	// Call from Startup_AFTER
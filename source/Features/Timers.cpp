@@ -2,6 +2,9 @@
 
 #include <WS2tcpip.h>
 #include "Features/TempBan.hpp"
+#include "Features/SaveScheduler.hpp"
+#include "Features/CharacterIndex.hpp"
+#include "Features/AdminRights.hpp"
 
 CTimer::CTimer(const std::string& sFunc, uint iWarn) : sFunction(sFunc), iWarning(iWarn)
 {
@@ -44,6 +47,35 @@ void TimerTempBanCheck()
 	}
 }
 
+/**************************************************************************************************************
+write queued character saves
+**************************************************************************************************************/
+
+void TimerProcessSaveQueue()
+{
+	TRY_HOOK
+	{
+		SaveScheduler::i()->ProcessQueue();
+
+		// Write the index updates of this tick's saves together
+		CharacterIndex::i()->Flush();
+	}
+	CATCH_HOOK({})
+}
+
+/**************************************************************************************************************
+pick up edits made to the admin files
+**************************************************************************************************************/
+
+void TimerRefreshAdminRights()
+{
+	TRY_HOOK
+	{
+		AdminRights::i()->Refresh();
+	}
+	CATCH_HOOK({})
+}
+
 /**************************************************************************************************************
 check if players should be kicked
 **************************************************************************************************************/
@@ -227,7 +259,7 @@ void TimerCheckResolveResults()
 					Hk::Player::Kick(ip.client);
 				}
 			}
-			ClientInfo[ip.client].wscHostname = ip.wscHostname;
+			ClientInfoCold[ip.client].wscHostname = ip.wscHostname;
 		}
 
 		g_lstResolveIPsResult.clear();
@@ -1,5 +1,6 @@
 ﻿#include "Global.hpp"
 #include "Features/Mail.hpp"
+#include "Features/PlayerGrid.hpp"
 
 #define PRINT_ERROR()                                                     \
 	{                                                                     \
@@ -19,21 +20,51 @@
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void PrintUserCmdText(ClientId client, const std::wstring& text)
+UserCmdWriter::UserCmdWriter(ClientId client) : client(client) {}
+
+UserCmdWriter::~UserCmdWriter() { Flush(); }
+
+void UserCmdWriter::AddLine(std::wstring_view line)
 {
-	auto newLineChar = text.find(L"\n");
-	if (newLineChar == std::wstring::npos)
-	{
-		std::wstring xml = std::format(L"<TRA data=\"{}\" mask=\"-1\"/><TEXT>{}</TEXT>", FLHookConfig::i()->messages.msgStyle.userCmdStyle, XMLText(text));
-		Hk::Message::FMsg(client, xml);
-	}
+	const std::wstring text = XMLText(std::wstring(line));
+	if (!xml.empty() && xml.length() + text.length() > MaxMessageLength)
+		Flush();
+
+	if (xml.empty())
+		xml = std::format(L"<TRA data=\"{}\" mask=\"-1\"/>", FLHookConfig::i()->messages.msgStyle.userCmdStyle);
 	else
+		xml += L"<PARA/>";
+
+	xml += L"<TEXT>";
+	xml += text;
+	xml += L"</TEXT>";
+}
+
+void UserCmdWriter::Print(const std::wstring& text)
+{
+	const std::wstring_view view = text;
+	size_t start = 0;
+	for (size_t end = view.find(L'\n'); end != std::wstring_view::npos; end = view.find(L'\n', start))
 	{
-		// Split text into two strings, one from the beginning to the character before newLineChar, and one after newLineChar till the end.
-		// It will then recursively call itself for each new line char until the original text is all displayed.
-		PrintUserCmdText(client, text.substr(0, newLineChar));
-		PrintUserCmdText(client, text.substr(newLineChar + 1, std::wstring::npos));
+		AddLine(view.substr(start, end - start));
+		start = end + 1;
 	}
+	AddLine(view.substr(start));
+}
+
+void UserCmdWriter::Flush()
+{
+	if (xml.empty())
+		return;
+
+	Hk::Message::FMsg(client, xml);
+	xml.clear();
+}
+
+void PrintUserCmdText(ClientId client, const std::wstring& text)
+{
+	UserCmdWriter writer(client);
+	writer.Print(text);
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -51,30 +82,9 @@ void PrintLocalUserCmdText(ClientId client, const std::wstring& msg, float dista
 	uint iSystem;
 	pub::Player::GetSystem(client, iSystem);
 
-	// For all players in system...
-	PlayerData* playerDb = nullptr;
-	while ((playerDb = Players.traverse_active(playerDb)))
-	{
-		// Get the this player's current system and location in the system.
-		ClientId client2 = playerDb->iOnlineId;
-		uint iSystem2 = 0;
-		pub::Player::GetSystem(client2, iSystem2);
-		if (iSystem != iSystem2)
-			continue;
-
-		uint ship2;
-		pub::Player::GetShip(client2, ship2);
-
-		Vector pos2;
-		Matrix rot2;
-		pub::SpaceObj::GetLocation(ship2, pos2, rot2);
-
-		// Is player within the specified range of the sending char.
-		if (Hk::Math::Distance3D(pos, pos2) > distance)
-			continue;
-
+	// For all players in space within the specified range of the sending char...
+	for (const uint client2 : PlayerGrid::c()->QueryRadius(iSystem, pos, distance))
 		PrintUserCmdText(client2, msg);
-	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -261,7 +271,7 @@ void UserCmd_Ignore(ClientId& client, const std::wstring& param)
 		}
 	}
 
-	if (ClientInfo[client].lstIgnore.size() > FLHookConfig::i()->userCommands.userCmdMaxIgnoreList)
+	if (ClientInfoCold[client].ignoreList.Size() > FLHookConfig::i()->userCommands.userCmdMaxIgnoreList)
 	{
 		PrintUserCmdText(client, L"Error: Too many entries in the ignore list, please delete an entry first!");
 		return;
@@ -269,13 +279,13 @@ void UserCmd_Ignore(ClientId& client, const std::wstring& param)
 
 	// save to ini
 	GET_USERFILE(scUserFile)
-	IniWriteW(scUserFile, "IgnoreList", std::to_string((int)ClientInfo[client].lstIgnore.size() + 1), character + L" " + flags);
+	IniWriteW(scUserFile, "IgnoreList", std::to_string((int)ClientInfoCold[client].ignoreList.Size() + 1), character + L" " + flags);
 
 	// save in ClientInfo
 	IGNORE_INFO ii;
 	ii.character = character;
 	ii.wscFlags = flags;
-	ClientInfo[client].lstIgnore.push_back(ii);
+	ClientInfoCold[client].ignoreList.Add(ii);
 
 	// send confirmation msg
 	PRINT_OK()
@@ -306,7 +316,7 @@ void UserCmd_IgnoreID(ClientId& client, const std::wstring& param)
 		return;
 	}
 
-	if (ClientInfo[client].lstIgnore.size() > FLHookConfig::i()->userCommands.userCmdMaxIgnoreList)
+	if (ClientInfoCold[client].ignoreList.Size() > FLHookConfig::i()->userCommands.userCmdMaxIgnoreList)
 	{
 		PrintUserCmdText(client, L"Error: Too many entries in the ignore list, please delete an entry first!");
 		return;
@@ -323,13 +333,13 @@ void UserCmd_IgnoreID(ClientId& client, const std::wstring& param)
 
 	// save to ini
 	GET_USERFILE(scUserFile)
-	IniWriteW(scUserFile, "IgnoreList", std::to_string((int)ClientInfo[client].lstIgnore.size() + 1), character + L" " + flags);
+	IniWriteW(scUserFile, "IgnoreList", std::to_string((int)ClientInfoCold[client].ignoreList.Size() + 1), character + L" " + flags);
 
 	// save in ClientInfo
 	IGNORE_INFO ii;
 	ii.character = character;
 	ii.wscFlags = flags;
-	ClientInfo[client].lstIgnore.push_back(ii);
+	ClientInfoCold[client].ignoreList.Add(ii);
 
 	// send confirmation msg
 	PrintUserCmdText(client, std::format(L"OK, \"{}\" added to ignore list", character));
@@ -345,16 +355,17 @@ void UserCmd_IgnoreList(ClientId& client, [[maybe_unused]] const std::wstring& p
 		return;
 	}
 
-	PrintUserCmdText(client, L"Id | Charactername | Flags");
+	UserCmdWriter writer(client);
+	writer.Print(L"Id | Charactername | Flags");
 	int i = 1;
-	for (auto& ignore : ClientInfo[client].lstIgnore)
+	for (auto& ignore : ClientInfoCold[client].ignoreList.GetEntries())
 	{
-		PrintUserCmdText(client, std::format(L"{} | %s | %s", i, ignore.character.c_str(), ignore.wscFlags));
+		writer.Print(std::format(L"{} | {} | {}", i, ignore.character, ignore.wscFlags));
 		i++;
 	}
 
 	// send confirmation msg
-	PRINT_OK()
+	writer.Print(L"OK");
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -384,47 +395,31 @@ void UserCmd_DelIgnore(ClientId& client, const std::wstring& param)
 	if (!idToDelete.compare(L"*"))
 	{ // delete all
 		IniDelSection(scUserFile, "IgnoreList");
-		ClientInfo[client].lstIgnore.clear();
+		ClientInfoCold[client].ignoreList.Clear();
 		PRINT_OK()
 		return;
 	}
 
-	std::list<uint> lstDelete;
+	std::vector<uint> idsToDelete;
 	for (uint j = 1; !idToDelete.empty(); j++)
 	{
 		uint iId = ToInt(idToDelete.c_str());
-		if (!iId || iId > ClientInfo[client].lstIgnore.size())
+		if (!iId || iId > ClientInfoCold[client].ignoreList.Size())
 		{
 			PrintUserCmdText(client, L"Error: Invalid Id");
 			return;
 		}
 
-		lstDelete.push_back(iId);
+		idsToDelete.push_back(iId);
 		idToDelete = GetParam(param, ' ', j);
 	}
 
-	lstDelete.sort(std::greater<uint>());
-
-	ClientInfo[client].lstIgnore.reverse();
-	for (const auto& del : lstDelete)
-	{
-		uint iCurId = ClientInfo[client].lstIgnore.size();
-		for (auto ignoreIt = ClientInfo[client].lstIgnore.begin(); ignoreIt != ClientInfo[client].lstIgnore.end(); ++ignoreIt)
-		{
-			if (iCurId == del)
-			{
-				ClientInfo[client].lstIgnore.erase(ignoreIt);
-				break;
-			}
-			iCurId--;
-		}
-	}
-	ClientInfo[client].lstIgnore.reverse();
+	ClientInfoCold[client].ignoreList.Erase(idsToDelete);
 
 	// send confirmation msg
 	IniDelSection(scUserFile, "IgnoreList");
 	int i = 1;
-	for (const auto& ignore : ClientInfo[client].lstIgnore)
+	for (const auto& ignore : ClientInfoCold[client].ignoreList.GetEntries())
 	{
 		IniWriteW(scUserFile, "IgnoreList", std::to_string(i), ignore.character + L" " + ignore.wscFlags);
 		i++;
@@ -436,11 +431,12 @@ void UserCmd_DelIgnore(ClientId& client, const std::wstring& param)
 
 void UserCmd_Ids(ClientId& client, [[maybe_unused]] const std::wstring& param)
 {
+	UserCmdWriter writer(client);
 	for (auto& player : Hk::Admin::GetPlayers())
 	{
-		PrintUserCmdText(client, std::format(L"{} = {} | ", player.character, player.client));
+		writer.Print(std::format(L"{} = {} | ", player.character, player.client));
 	}
-	PrintUserCmdText(client, L"OK");
+	writer.Print(L"OK");
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -544,8 +540,9 @@ void UserCmd_FactionInvite(ClientId& client, const std::wstring& param)
 
 void UserCmd_FLHookInfo(ClientId& client, [[maybe_unused]] const std::wstring& param)
 {
-	PrintUserCmdText(client, L"This server is running FLHook v" + VersionInformation);
-	PrintUserCmdText(client, L"Running plugins:");
+	UserCmdWriter writer(client);
+	writer.Print(L"This server is running FLHook v" + VersionInformation);
+	writer.Print(L"Running plugins:");
 
 	bool bRunning = false;
 	for (const auto& plugin : PluginManager::ir())
@@ -554,10 +551,10 @@ void UserCmd_FLHookInfo(ClientId& client, [[maybe_unused]] const std::wstring& p
 			continue;
 
 		bRunning = true;
-		PrintUserCmdText(client, std::format(L"- {}", stows(plugin->name)));
+		writer.Print(std::format(L"- {}", stows(plugin->name)));
 	}
 	if (!bRunning)
-		PrintUserCmdText(client, L"- none -");
+		writer.Print(L"- none -");
 }
 
 void UserCmdDelMail(ClientId& client, const std::wstring& param)
@@ -605,10 +602,11 @@ void UserCmdReadMail(ClientId& client, const std::wstring& param)
 	}
 
 	const auto& item = mail.value();
-	PrintUserCmdText(client, std::format(L"From: {}", stows(item.author)));
-	PrintUserCmdText(client, std::format(L"Subject: {}", stows(item.subject)));
-	PrintUserCmdText(client, std::format(L"Date: {:%F %T}", UnixToSysTime(item.timestamp)));
-	PrintUserCmdText(client, stows(item.body));
+	UserCmdWriter writer(client);
+	writer.Print(std::format(L"From: {}", stows(item.author)));
+	writer.Print(std::format(L"Subject: {}", stows(item.subject)));
+	writer.Print(std::format(L"Date: {:%F %T}", UnixToSysTime(item.timestamp)));
+	writer.Print(stows(item.body));
 }
 
 void UserCmdListMail(ClientId& client, const std::wstring& param)
@@ -636,11 +634,12 @@ void UserCmdListMail(ClientId& client, const std::wstring& param)
 		return;
 	}
 
-	PrintUserCmdText(client, std::format(L"Printing mail of page {}", mailList.size()));
+	UserCmdWriter writer(client);
+	writer.Print(std::format(L"Printing mail of page {}", mailList.size()));
 	for (const auto& item : mailList)
 	{
 		// |    Id.) Subject (unread) - Author - Time
-		PrintUserCmdText(client,
+		writer.Print(
 		    stows(std::format(
 		        "|    {}.) {} {}- {} - {:%F %T}", item.id, item.subject, item.unread ? "(unread) " : "", item.author, UnixToSysTime(item.timestamp))));
 	}
@@ -777,17 +776,18 @@ void UserCmd_Help(ClientId& client, const std::wstring& paramView)
 		return;
 	}
 
+	UserCmdWriter writer(client);
 	const auto& plugins = PluginManager::ir();
 	if (paramView.find(L' ') == std::string::npos)
 	{
-		PrintUserCmdText(client, L"The following command modules are available to you. Use /help <module> [command] for detailed information.");
-		PrintUserCmdText(client, L"core");
+		writer.Print(L"The following command modules are available to you. Use /help <module> [command] for detailed information.");
+		writer.Print(L"core");
 		for (const auto& plugin : plugins)
 		{
 			if (!plugin->commands || plugin->commands->empty())
 				continue;
 
-			PrintUserCmdText(client, ToLower(stows(plugin->shortName)));
+			writer.Print(ToLower(stows(plugin->shortName)));
 		}
 		return;
 	}
@@ -802,20 +802,20 @@ void UserCmd_Help(ClientId& client, const std::wstring& paramView)
 			for (const auto& i : UserCmds)
 			{
 				if (i.command.index() == 0)
-					PrintUserCmdText(client, std::get<std::wstring>(i.command));
+					writer.Print(std::get<std::wstring>(i.command));
 				else
-					PrintUserCmdText(client, i.usage);
+					writer.Print(i.usage);
 			}
 		}
 		else if (const auto& userCommand = std::ranges::find_if(UserCmds, [&cmd](const UserCommand& userCmd) { return GetCommand(cmd, userCmd); });
 		         userCommand != UserCmds.end())
 		{
-			PrintUserCmdText(client, userCommand->usage);
-			PrintUserCmdText(client, userCommand->description);
+			writer.Print(userCommand->usage);
+			writer.Print(userCommand->description);
 		}
 		else
 		{
-			PrintUserCmdText(client, std::format(L"Command '{}' not found within module 'Core'", cmd.c_str()));
+			writer.Print(std::format(L"Command '{}' not found within module 'Core'", cmd.c_str()));
 		}
 		return;
 	}
@@ -825,7 +825,7 @@ void UserCmd_Help(ClientId& client, const std::wstring& paramView)
 
 	if (pluginIterator == plugins.end())
 	{
-		PrintUserCmdText(client, L"Command module not found.");
+		writer.Print(L"Command module not found.");
 		return;
 	}
 
@@ -838,113 +838,249 @@ void UserCmd_Help(ClientId& client, const std::wstring& paramView)
 			for (const auto& command : *plugin->commands)
 			{
 				if (command.command.index() == 0)
-					PrintUserCmdText(client, std::get<std::wstring>(command.command));
+					writer.Print(std::get<std::wstring>(command.command));
 				else
-					PrintUserCmdText(client, command.usage);
+					writer.Print(command.usage);
 			}
 		}
 		else if (const auto& userCommand = std::ranges::find_if(*plugin->commands, [&cmd](const UserCommand& userCmd) { return GetCommand(cmd, userCmd); });
 		         userCommand != plugin->commands->end())
 		{
-			PrintUserCmdText(client, userCommand->usage);
-			PrintUserCmdText(client, userCommand->description);
+			writer.Print(userCommand->usage);
+			writer.Print(userCommand->description);
 		}
 		else
 		{
-			PrintUserCmdText(client, std::format(L"Command '{}' not found within module '{}'", cmd, stows(plugin->shortName)));
+			writer.Print(std::format(L"Command '{}' not found within module '{}'", cmd, stows(plugin->shortName)));
 		}
 	}
 	else
 	{
-		PrintUserCmdText(client, std::format(L"Module '{}' does not have commands.", stows(plugin->shortName)));
+		writer.Print(std::format(L"Module '{}' does not have commands.", stows(plugin->shortName)));
 	}
 }
 
-bool ProcessPluginCommand(ClientId& client, const std::wstring& originalCmdString, const std::vector<UserCommand>& commands)
+/** Every user command of the plugins and the core in a single trie. Walking it with the lower case input finds all commands that
+ * end at a word boundary of the input in one pass, independent of how many commands are registered */
+class UserCommandIndex
 {
-	const std::wstring inputLower = ToLower(originalCmdString);
-	for (const auto& cmdObj : commands)
+	struct Target
 	{
-		std::optional<std::wstring> param;
-		if (cmdObj.command.index() == 0)
-		{
-			const auto& subCmd = std::get<std::wstring>(cmdObj.command);
+		//! Position in the old dispatch order: plugins sorted by name, then the core commands, each in the order they were declared in
+		uint rank;
+		const UserCommand* command;
+	};
 
-			// No command match
-			if (inputLower.rfind(subCmd, 0) != 0)
-			{
-				continue;
-			}
+	struct Node
+	{
+		//! Sorted by character
+		std::vector<std::pair<wchar_t, uint>> children;
+		//! Sorted by rank, the first one wins
+		std::vector<Target> targets;
+	};
+
+	std::vector<Node> nodes;
+	uint nextRank = 0;
 
-			// If the length of the input is greater than the command, check the last character and assert its not a space
-			if (originalCmdString.length() > subCmd.length())
+	void Insert(const std::wstring& name, const UserCommand* command, uint rank)
+	{
+		uint node = 0;
+		for (const wchar_t c : name)
+		{
+			auto& children = nodes[node].children;
+			auto child = std::ranges::lower_bound(children, c, {}, &std::pair<wchar_t, uint>::first);
+			if (child == children.end() || child->first != c)
 			{
-				if (originalCmdString[subCmd.length()] != ' ')
-				{
-					continue;
-				}
-				param = originalCmdString.substr(subCmd.length() + 1);
+				const uint index = nodes.size();
+				children.insert(child, {c, index});
+				nodes.emplace_back();
+				node = index;
 			}
 			else
-			{
-				param = L"";
-			}
+				node = child->second;
 		}
-		else
+
+		if (node)
+			nodes[node].targets.push_back({rank, command});
+	}
+
+	void Add(const std::vector<UserCommand>& commands)
+	{
+		for (const auto& command : commands)
 		{
-			for (const auto& subCmd : std::get<std::vector<std::wstring>>(cmdObj.command))
+			const uint rank = nextRank++;
+			if (command.command.index() == 0)
+				Insert(std::get<std::wstring>(command.command), &command, rank);
+			else
 			{
-				if (inputLower.rfind(subCmd, 0) != 0 || (originalCmdString.length() > subCmd.length() && originalCmdString[subCmd.length()] != ' '))
-				{
-					continue;
-				}
-
-				param = originalCmdString;
+				for (const auto& alias : std::get<std::vector<std::wstring>>(command.command))
+					Insert(alias, &command, rank);
 			}
 		}
-		if (param.has_value())
+	}
+
+  public:
+	void Build()
+	{
+		nodes = {Node {}};
+		nextRank = 0;
+
+		for (const auto& plugin : PluginManager::ir())
 		{
-			std::wstring character = (wchar_t*)Players.GetActiveCharacterName(client);
-			AddLog(LogType::UserLogCmds, LogLevel::Info, wstos(std::format(L"{}: {}", character.c_str(), originalCmdString.c_str())));
+			if (plugin->commands)
+				Add(*plugin->commands);
+		}
+
+		Add(UserCmds);
+	}
 
-			try
+	/// <returns>The command with the highest precedence and the length of the name it matched with, or nullptr if there is none.</returns>
+	std::pair<const UserCommand*, size_t> Find(const std::wstring& inputLower) const
+	{
+		const Target* best = nullptr;
+		size_t matchLength = 0;
+
+		uint node = 0;
+		for (size_t i = 0;; i++)
+		{
+			// A command only matches if it is followed by a space or the end of the input
+			if (const auto& targets = nodes[node].targets; !targets.empty() && (i == inputLower.length() || inputLower[i] == L' '))
 			{
-				if (cmdObj.proc.index() == 0)
+				if (!best || targets.front().rank < best->rank)
 				{
-					std::get<UserCmdProc>(cmdObj.proc)(client);
+					best = &targets.front();
+					matchLength = i;
 				}
-				else
-				{
-					std::get<UserCmdProcWithParam>(cmdObj.proc)(client, param.value());
-				}
-
-				AddLog(LogType::UserLogCmds, LogLevel::Info, "finished");
-			}
-			catch (std::exception const& ex)
-			{
-				AddLog(LogType::UserLogCmds, LogLevel::Err, std::format("exception {}", ex.what()));
 			}
 
-			return true;
+			if (i == inputLower.length())
+				break;
+
+			const auto& children = nodes[node].children;
+			const auto child = std::ranges::lower_bound(children, inputLower[i], {}, &std::pair<wchar_t, uint>::first);
+			if (child == children.end() || child->first != inputLower[i])
+				break;
+
+			node = child->second;
 		}
+
+		return {best ? best->command : nullptr, matchLength};
 	}
-	return false;
 };
 
+UserCommandIndex userCommandIndex;
+bool userCommandIndexDirty = true;
+
+void UserCmd_InvalidateIndex()
+{
+	userCommandIndexDirty = true;
+}
+
+/** Refills the budget of the client for the time since its last command and takes one command out of it.
+ * @returns False if the client has to wait before sending another command */
+bool TakeUserCmdBudget(ClientId client)
+{
+	const auto& config = FLHookConfig::c()->userCommands;
+	if (!config.userCmdRateLimitBurst && !config.userCmdCostBudgetMs)
+		return true;
+
+	auto& budget = ClientInfoCold[client].userCmdBudget;
+	const mstime now = Hk::Time::GetUnixMiliseconds();
+	if (!budget.lastRefill)
+	{
+		budget.commands = config.userCmdRateLimitBurst;
+		budget.costMs = config.userCmdCostBudgetMs;
+	}
+	else
+	{
+		const double minutes = static_cast<double>(now - budget.lastRefill) / 60000.0;
+		budget.commands = std::min(budget.commands + minutes * config.userCmdRateLimitPerMinute, static_cast<double>(config.userCmdRateLimitBurst));
+		budget.costMs = std::min(budget.costMs + minutes * config.userCmdCostBudgetPerMinuteMs, static_cast<double>(config.userCmdCostBudgetMs));
+	}
+	budget.lastRefill = now;
+
+	// Each bucket is only checked if it is enabled
+	if ((config.userCmdRateLimitBurst && budget.commands < 1.0) || (config.userCmdCostBudgetMs && budget.costMs <= 0.0))
+		return false;
+
+	if (config.userCmdRateLimitBurst)
+		budget.commands -= 1.0;
+	return true;
+}
+
+/** Runs the command and returns the server time it took in milliseconds */
+double ExecuteUserCommand(ClientId& client, const std::wstring& originalCmdString, const UserCommand& cmdObj, const std::wstring& param)
+{
+	std::wstring character = (wchar_t*)Players.GetActiveCharacterName(client);
+	AddLog(LogType::UserLogCmds, LogLevel::Info, wstos(std::format(L"{}: {}", character.c_str(), originalCmdString.c_str())));
+
+	const auto start = std::chrono::steady_clock::now();
+	try
+	{
+		if (cmdObj.proc.index() == 0)
+		{
+			std::get<UserCmdProc>(cmdObj.proc)(client);
+		}
+		else
+		{
+			std::get<UserCmdProcWithParam>(cmdObj.proc)(client, param);
+		}
+
+		AddLog(LogType::UserLogCmds, LogLevel::Info, "finished");
+	}
+	catch (std::exception const& ex)
+	{
+		AddLog(LogType::UserLogCmds, LogLevel::Err, std::format("exception {}", ex.what()));
+	}
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 bool UserCmd_Process(ClientId client, const std::wstring& cmd)
 {
 	auto [pluginRet, pluginSkip] = CallPluginsBefore<bool>(HookedCall::FLHook__UserCommand__Process, client, cmd);
 	if (pluginSkip)
 		return pluginRet;
 
-	for (const auto& plugins = PluginManager::ir(); const std::shared_ptr<PluginData> i : plugins)
+	if (userCommandIndexDirty)
 	{
-		if (i->commands && ProcessPluginCommand(client, cmd, *i->commands))
+		userCommandIndex.Build();
+		userCommandIndexDirty = false;
+	}
+
+	const auto [command, matchLength] = userCommandIndex.Find(ToLower(cmd));
+	if (!command)
+		return false;
+
+	// Commands with aliases receive the whole input, the others only what follows the command
+	std::wstring param;
+	if (command->command.index() != 0)
+		param = cmd;
+	else if (cmd.length() > matchLength)
+		param = cmd.substr(matchLength + 1);
+
+	auto& budget = ClientInfoCold[client].userCmdBudget;
+	if (!TakeUserCmdBudget(client))
+	{
+		if (!budget.throttled && FLHookConfig::c()->userCommands.logThrottledUserCmds)
 		{
-			return true;
+			const std::wstring character = (wchar_t*)Players.GetActiveCharacterName(client);
+			AddLog(LogType::UserLogCmds,
+			    LogLevel::Warn,
+			    wstos(std::format(L"Throttling user commands of {} (commands left {:.1f}, server time left {:.1f} ms): {}",
+			        character,
+			        budget.commands,
+			        budget.costMs,
+			        cmd)));
 		}
+		budget.throttled = true;
+
+		PrintUserCmdText(client, L"Error: You are sending commands too quickly, please wait a moment.");
+		return true;
 	}
+	budget.throttled = false;
 
-	// In-built commands
-	return ProcessPluginCommand(client, cmd, UserCmds);
+	// Expensive commands drain the budget faster than cheap ones
+	budget.costMs -= ExecuteUserCommand(client, cmd, *command, param);
+	return true;
 }
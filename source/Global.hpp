@@ -2,6 +2,7 @@
 
 #include <FLHook.hpp>
 #include <unordered_set>
+#include <Tools/FlatIdMap.hpp>
 
 bool FLHookInit();
 void FLHookInit_Pre();
@@ -19,6 +20,8 @@ void ClearClientInfo(ClientId client);
 void LoadUserSettings(ClientId client);
 
 bool UserCmd_Process(ClientId client, const std::wstring& wscCmd);
+// Marks the user command lookup as outdated, it is rebuilt before the next command is processed
+void UserCmd_InvalidateIndex();
 
 bool AllowPlayerDamage(ClientId client, ClientId clientTarget);
 
@@ -67,7 +70,20 @@ namespace IEngineHook
 	extern FARPROC g_OldLaunchPosition;
 	extern FARPROC g_OldLoadReputationFromCharacterFile;
 
-	extern std::unordered_set<uint> playerShips;
+	extern FlatIdSet playerShips;
+
+	struct ObjectCacheStats
+	{
+		uint64 hits = 0;
+		uint64 misses = 0;
+		uint64 evictions = 0;
+		size_t size = 0;
+		size_t capacity = 0;
+	};
+
+	ObjectCacheStats GetSolarCacheStats();
+	ObjectCacheStats GetNonSolarCacheStats();
+	std::vector<std::pair<std::string, uint>> GetLiveObjectCounts();
 } // namespace IEngine
 
 namespace Hk
@@ -86,9 +102,20 @@ namespace Hk
 		void LoadPersonalities();
 	}
 
+	namespace Message
+	{
+		/// Compares the encoded message templates against the XML reader for a set of typical messages and disables them on any
+		/// difference.
+		bool CheckEncodeTemplates();
+	} // namespace Message
+
 	namespace Client
 	{
 		uint ExtractClientID(const std::variant<uint, std::wstring>& player);
+		void SetClientShip(ClientId client, uint ship);
+		void SetClientCharacterName(ClientId client, const std::wstring& character);
+		void SetPlayerSystem(ClientId client, uint system);
+		void UpdatePlayerSystem(ClientId client);
 		cpp::result<CAccount*, Error> ExtractAccount(const std::variant<uint, std::wstring>& player);
 	} // namespace Client
 } // namespace Hk
@@ -111,6 +138,8 @@ void TimerCheckKick();
 void TimerNPCAndF1Check();
 void ThreadResolver();
 void TimerCheckResolveResults();
+void TimerProcessSaveQueue();
+void TimerRefreshAdminRights();
 
 void BaseDestroyed(uint objectId, ClientId clientBy);
 
@@ -312,6 +341,8 @@ class PluginManager : public Singleton<PluginManager>
 	void load(const std::wstring& fileName, CCmds*, bool);
 	cpp::result<std::wstring, Error> unload(const std::string& shortName);
 
+	bool hasHooks(HookedCall target, HookStep step) const { return !pluginHooks_[uint(target) * magic_enum::enum_count<HookStep>() + uint(step)].empty(); }
+
 	auto begin() { return plugins_.begin(); }
 	auto end() { return plugins_.end(); }
 	auto begin() const { return plugins_.begin(); }
@@ -1,4 +1,5 @@
 #include "Global.hpp"
+#include "Features/AdminRights.hpp"
 
 bool g_bNPCDisabled;
 
@@ -105,7 +106,7 @@ some_error:
 		// get ip
 		pi.wscIP = GetPlayerIP(client);
 
-		pi.wscHostname = ClientInfo[client].wscHostname;
+		pi.wscHostname = ClientInfoCold[client].wscHostname;
 
 		return pi;
 	}
@@ -156,9 +157,7 @@ some_error:
 		}
 
 		auto dir = Hk::Client::GetAccountDirName(acc.value());
-
-		std::string scAdminFile = CoreGlobals::c()->accPath + wstos(dir) + "\\flhookadmin.ini";
-		IniWrite(scAdminFile, "admin", "rights", wstos(wscRights));
+		AdminRights::i()->Set(dir, wstos(wscRights));
 		return {};
 	}
 
@@ -173,17 +172,13 @@ some_error:
 		}
 
 		std::wstring dir = Hk::Client::GetAccountDirName(acc.value());
-		std::string scAdminFile = CoreGlobals::c()->accPath + wstos(dir) + "\\flhookadmin.ini";
-
-		WIN32_FIND_DATA fd;
-		HANDLE hFind = FindFirstFile(scAdminFile.c_str(), &fd);
-		if (hFind == INVALID_HANDLE_VALUE)
+		const auto rights = AdminRights::i()->Get(dir);
+		if (!rights)
 		{
 			return cpp::fail(Error::NoAdmin);
 		}
 
-		FindClose(hFind);
-		return stows(IniGetS(scAdminFile, "admin", "rights", ""));
+		return stows(*rights);
 	}
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -197,8 +192,7 @@ some_error:
 		}
 
 		std::wstring dir = Hk::Client::GetAccountDirName(acc.value());
-		std::string scAdminFile = CoreGlobals::c()->accPath + wstos(dir) + "\\flhookadmin.ini";
-		DeleteFile(scAdminFile.c_str());
+		AdminRights::i()->Remove(dir);
 		return {};
 	}
 
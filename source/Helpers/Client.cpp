@@ -68,8 +68,31 @@ namespace Hk::Client
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+	// Case folded active character names of online clients. Hits are checked against the active character,
+	// so a stale entry only costs a fallback to the account lookup below
+	std::unordered_map<std::wstring, uint> characterNameToClient;
+	std::array<std::wstring, MaxClientId + 1> clientCharacterNames;
+
+	void SetClientCharacterName(ClientId client, const std::wstring& character)
+	{
+		auto& current = clientCharacterNames[client];
+		if (const auto entry = characterNameToClient.find(current); entry != characterNameToClient.end() && entry->second == client)
+			characterNameToClient.erase(entry);
+
+		current = ToLower(character);
+		if (!current.empty())
+			characterNameToClient[current] = client;
+	}
+
 	cpp::result<const uint, Error> GetClientIdFromCharName(const std::wstring& character)
 	{
+		if (const auto entry = characterNameToClient.find(ToLower(character)); entry != characterNameToClient.end() && IsValidClientID(entry->second))
+		{
+			const auto* active = reinterpret_cast<const wchar_t*>(Players.GetActiveCharacterName(entry->second));
+			if (active && _wcsicmp(active, character.c_str()) == 0)
+				return entry->second;
+		}
+
 		const auto acc = GetAccountByCharName(character);
 		if (acc.has_error())
 			return cpp::fail(acc.error());
@@ -213,7 +236,23 @@ namespace Hk::Client
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	cpp::result<ClientId, Error> GetClientIdByShip(const ShipId ship)
+	// Reverse index of ClientInfo[client].ship, kept in sync by SetClientShip
+	std::unordered_map<uint, uint> shipToClient;
+
+	void SetClientShip(ClientId client, uint ship)
+	{
+		if (const uint oldShip = ClientInfo[client].ship)
+		{
+			if (const auto entry = shipToClient.find(oldShip); entry != shipToClient.end() && entry->second == client)
+				shipToClient.erase(entry);
+		}
+
+		ClientInfo[client].ship = ship;
+		if (ship)
+			shipToClient[ship] = client;
+	}
+
+	static cpp::result<ClientId, Error> FindClientIdByShip(const ShipId ship)
 	{
 		if (auto foundClient = std::ranges::find_if(ClientInfo, [ship](const CLIENT_INFO& ci) { return ci.ship == ship; }); 
 			foundClient != ClientInfo.end())
@@ -222,6 +261,36 @@ namespace Hk::Client
 		return cpp::fail(Error::InvalidShip);
 	}
 
+	cpp::result<ClientId, Error> GetClientIdByShip(const ShipId ship)
+	{
+		// Every client without a ship has 0 stored, so it never identifies a client
+		if (!ship)
+			return cpp::fail(Error::InvalidShip);
+
+		const auto entry = shipToClient.find(ship);
+		const bool found = entry != shipToClient.end();
+
+		// Validate the index against a full scan
+		if (FLHookConfig::c()->general.debugMode)
+		{
+			if (const auto scanned = FindClientIdByShip(ship); scanned.has_value() != found || (found && scanned.value() != entry->second))
+			{
+				AddLog(LogType::Normal,
+				    LogLevel::Err,
+				    std::format("Ship index mismatch for ship {}: index={} scan={}",
+				        ship,
+				        found ? std::to_string(entry->second) : "none",
+				        scanned.has_value() ? std::to_string(scanned.value()) : "none"));
+				return scanned;
+			}
+		}
+
+		if (!found)
+			return cpp::fail(Error::InvalidShip);
+
+		return entry->second;
+	}
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	std::wstring GetAccountDirName(const CAccount* acc)
@@ -540,15 +609,68 @@ namespace Hk::Client
 		return cpp::fail(Error::PlayerNotLoggedIn);
 	}
 
-	std::vector<uint> getAllPlayersInSystem(SystemId system)
+	// Intrusive per system lists of online players, linked through their client ids. 0 terminates a list
+	struct RosterEntry
 	{
-		PlayerData* playerData = nullptr;
-		std::vector<uint> playersInSystem;
-		while ((playerData = Players.traverse_active(playerData)))
+		uint system = 0;
+		uint prev = 0;
+		uint next = 0;
+	};
+
+	std::array<RosterEntry, MaxClientId + 1> roster;
+	std::unordered_map<uint, uint> systemHeads;
+
+	void SetPlayerSystem(ClientId client, uint system)
+	{
+		auto& entry = roster[client];
+		if (entry.system == system)
+			return;
+
+		if (entry.system)
 		{
-			if (playerData->systemId == system)
-				playersInSystem.push_back(playerData->iOnlineId);
+			if (entry.prev)
+				roster[entry.prev].next = entry.next;
+			else if (entry.next)
+				systemHeads[entry.system] = entry.next;
+			else
+				systemHeads.erase(entry.system);
+
+			if (entry.next)
+				roster[entry.next].prev = entry.prev;
 		}
+
+		entry = {system, 0, 0};
+		if (!system)
+			return;
+
+		auto& head = systemHeads[system];
+		entry.next = head;
+		if (head)
+			roster[head].prev = client;
+		head = client;
+	}
+
+	void UpdatePlayerSystem(ClientId client)
+	{
+		if (client < 1 || client > MaxClientId)
+			return;
+
+		SetPlayerSystem(client, IsValidClientID(client) ? Players[client].systemId : 0);
+	}
+
+	ClientId GetFirstPlayerInSystem(SystemId system)
+	{
+		const auto head = systemHeads.find(system);
+		return head == systemHeads.end() ? 0 : head->second;
+	}
+
+	ClientId GetNextPlayerInSystem(ClientId client) { return client > MaxClientId ? 0 : roster[client].next; }
+
+	std::vector<uint> getAllPlayersInSystem(SystemId system)
+	{
+		std::vector<uint> playersInSystem;
+		for (uint player = GetFirstPlayerInSystem(system); player; player = GetNextPlayerInSystem(player))
+			playersInSystem.push_back(player);
 		return playersInSystem;
 	}
 }
\ No newline at end of file
@@ -1,14 +1,89 @@
 #include "Global.hpp"
+#include "Features/CharacterIndex.hpp"
 
 namespace Hk::Ini
 {
-	struct FLHOOK_PLAYER_DATA
+	struct CharacterIniData
 	{
 		std::string charfilename;
-		std::map<std::wstring, std::wstring> lines;
+		std::vector<std::pair<CharacterIniKey, CharacterIniValue>> values;
+		//! The serialized [flhook] section, only rebuilt when a value changed since the last save
+		std::string section;
+		bool dirty = false;
 	};
 
-	std::map<uint, FLHOOK_PLAYER_DATA> clients;
+	std::array<CharacterIniData, MaxClientId + 1> clients;
+
+	struct CharacterIniKeys
+	{
+		std::unordered_map<std::wstring, CharacterIniKey> ids;
+		std::vector<std::wstring> names;
+	};
+
+	CharacterIniKeys& GetKeys()
+	{
+		static CharacterIniKeys keys;
+		return keys;
+	}
+
+	CharacterIniData* GetClientData(ClientId client)
+	{
+		// The rename code logs in a temporary client above MaxClientId, that one never has any data
+		if (client > MaxClientId)
+			return nullptr;
+
+		return &clients[client];
+	}
+
+	CharacterIniValue* FindValue(CharacterIniData& data, CharacterIniKey key)
+	{
+		// Characters rarely have more than a handful of values, a linear scan over integer keys beats any lookup structure here
+		const auto value = std::ranges::find(data.values, key, &std::pair<CharacterIniKey, CharacterIniValue>::first);
+		return value == data.values.end() ? nullptr : &value->second;
+	}
+
+	const CharacterIniValue* FindValue(ClientId client, CharacterIniKey key)
+	{
+		auto* data = GetClientData(client);
+		if (!data || data->charfilename.empty())
+			return nullptr;
+
+		return FindValue(*data, key);
+	}
+
+	std::wstring CharacterIniValueToString(const CharacterIniValue& value)
+	{
+		if (const auto* str = std::get_if<std::wstring>(&value))
+			return *str;
+		if (const auto* b = std::get_if<bool>(&value))
+			return *b ? L"true" : L"false";
+		if (const auto* i = std::get_if<int64>(&value))
+			return std::to_wstring(*i);
+
+		// std::to_wstring would round to six decimal places
+		return std::format(L"{}", std::get<double>(value));
+	}
+
+	void SetValue(ClientId client, CharacterIniKey key, CharacterIniValue value)
+	{
+		auto* data = GetClientData(client);
+		if (!data)
+			return;
+
+		if (auto* existing = FindValue(*data, key))
+		{
+			if (*existing == value)
+				return;
+
+			*existing = std::move(value);
+		}
+		else
+		{
+			data->values.emplace_back(key, std::move(value));
+		}
+
+		data->dirty = true;
+	}
 
 	std::string GetAccountDir(ClientId client)
 	{
@@ -26,6 +101,51 @@ namespace Hk::Ini
 		return filename;
 	}
 
+	void AppendFlhookSection(CharacterIniData& clientData, const std::string& path)
+	{
+		const bool encryptFiles = !FLHookConfig::c()->general.disableCharfileEncryption;
+
+		if (clientData.dirty)
+		{
+			const auto& names = GetKeys().names;
+			clientData.section = "\n[flhook]\n";
+			for (const auto& [key, value] : clientData.values)
+			{
+				clientData.section += wstos(std::format(L"{} = {}\n", names[static_cast<uint>(key)], CharacterIniValueToString(value)));
+			}
+			clientData.dirty = false;
+		}
+
+		const auto writeFlhookSection = [&clientData](std::string& str) { str += clientData.section; };
+
+		std::fstream saveFile;
+		std::string data;
+		if (encryptFiles)
+		{
+			saveFile.open(path, std::ios::ate | std::ios::in | std::ios::out | std::ios::binary);
+
+			// Copy old version that we plan to rewrite
+			auto size = static_cast<size_t>(saveFile.tellg());
+			std::string buffer(size, ' ');
+			saveFile.seekg(0);
+			saveFile.read(&buffer[0], size); 
+
+			// Reset the file pointer so we can start overwriting
+			saveFile.seekg(0);
+			buffer = FlcDecode(buffer);
+			writeFlhookSection(buffer);
+			data = FlcEncode(buffer);
+		}
+		else
+		{
+			saveFile.open(path, std::ios::app | std::ios::binary);
+			writeFlhookSection(data);
+		}
+
+		saveFile.write(data.c_str(), data.size());
+		saveFile.close();
+	}
+
 	static PlayerData* CurrPlayer;
 	int __stdcall Cb_UpdateFile(char* filename, wchar_t* savetime, int b)
 	{
@@ -48,45 +168,16 @@ namespace Hk::Ini
 		{
 			ClientId client = CurrPlayer->iOnlineId;
 
-			std::string path = CoreGlobals::c()->accPath + GetAccountDir(client) + "\\" + filename;
-
-			const bool encryptFiles = !FLHookConfig::c()->general.disableCharfileEncryption;
-
-			const auto writeFlhookSection = [client](std::string& str) 
-			{
-				str += "\n[flhook]\n";
-				for (const auto& [key, value] : clients[client].lines)
-				{
-					str += wstos(std::format(L"{} = {}\n", key, value));
-				}
-			};
-
-			std::fstream saveFile;
-			std::string data;
-			if (encryptFiles)
-			{
-				saveFile.open(path, std::ios::ate | std::ios::in | std::ios::out | std::ios::binary);
-
-				// Copy old version that we plan to rewrite
-				auto size = static_cast<size_t>(saveFile.tellg());
-				std::string buffer(size, ' ');
-				saveFile.seekg(0);
-				saveFile.read(&buffer[0], size); 
-
-				// Reset the file pointer so we can start overwriting
-				saveFile.seekg(0);
-				buffer = FlcDecode(buffer);
-				writeFlhookSection(buffer);
-				data = FlcEncode(buffer);
-			}
-			else
+			// Nothing to re-add for characters without values, avoid decoding and rewriting the whole file
+			if (auto* clientData = GetClientData(client); clientData && !clientData->values.empty())
 			{
-				saveFile.open(path, std::ios::app | std::ios::binary);
-				writeFlhookSection(data);
+				std::string path = CoreGlobals::c()->accPath + GetAccountDir(client) + "\\" + filename;
+				AppendFlhookSection(*clientData, path);
 			}
 
-			saveFile.write(data.c_str(), data.size());
-			saveFile.close();
+			// The temporary client used by renames is indexed by Hk::Player::Rename once the file is complete
+			if (client <= MaxClientId)
+				CharacterIndex::i()->UpdateFromClient(client);
 		}
 
 		return retv;
@@ -100,14 +191,23 @@ namespace Hk::Ini
 		}
 	}
 
-	void CharacterClearClientInfo(ClientId client) { clients.erase(client); }
+	void CharacterClearClientInfo(ClientId client)
+	{
+		if (auto* data = GetClientData(client))
+			*data = CharacterIniData();
+	}
 
 	void CharacterSelect(CHARACTER_ID const charId, ClientId client)
 	{
 		std::string path = CoreGlobals::c()->accPath + GetAccountDir(client) + "\\" + charId.szCharFilename;
 
-		clients[client].charfilename = charId.szCharFilename;
-		clients[client].lines.clear();
+		auto* data = GetClientData(client);
+		if (!data)
+			return;
+
+		data->charfilename = charId.szCharFilename;
+		data->values.clear();
+		data->dirty = true;
 
 		// Read the flhook section so that we can rewrite after the save so that it isn't lost
 		INI_Reader ini;
@@ -120,7 +220,7 @@ namespace Hk::Ini
 					std::wstring tag;
 					while (ini.read_value())
 					{
-						clients[client].lines[stows(ini.get_name_ptr())] = stows(ini.get_value_string());
+						SetValue(client, InternCharacterIniKey(stows(ini.get_name_ptr())), stows(ini.get_value_string()));
 					}
 				}
 			}
@@ -131,7 +231,7 @@ namespace Hk::Ini
 	static bool patched = false;
 	void CharacterInit()
 	{
-		clients.clear();
+		std::ranges::fill(clients, CharacterIniData());
 		if (patched)
 			return;
 
@@ -217,59 +317,128 @@ namespace Hk::Ini
 		return {};
 	}
 
-	std::wstring GetCharacterIniString(ClientId client, const std::wstring& name)
+	CharacterIniKey InternCharacterIniKey(const std::wstring& name)
+	{
+		auto& keys = GetKeys();
+		if (const auto id = keys.ids.find(name); id != keys.ids.end())
+			return id->second;
+
+		const auto id = static_cast<CharacterIniKey>(keys.names.size());
+		keys.names.emplace_back(name);
+		keys.ids.emplace(name, id);
+		return id;
+	}
+
+	// Used by the getters, a name that was never interned has no value on any character and must not grow the key table
+	std::optional<CharacterIniKey> FindCharacterIniKey(const std::wstring& name)
+	{
+		const auto& ids = GetKeys().ids;
+		const auto id = ids.find(name);
+		return id == ids.end() ? std::nullopt : std::optional(id->second);
+	}
+
+	template<typename T>
+	T GetCharacterIniNumber(ClientId client, CharacterIniKey key)
 	{
-		if (!clients.contains(client))
-			return L"";
+		const auto* value = FindValue(client, key);
+		if (!value)
+			return T();
+
+		if (const auto* str = std::get_if<std::wstring>(value))
+		{
+			if constexpr (std::is_same_v<T, int>)
+				return wcstol(str->c_str(), nullptr, 10);
+			else if constexpr (std::is_same_v<T, uint>)
+				return wcstoul(str->c_str(), nullptr, 10);
+			else if constexpr (std::is_same_v<T, int64>)
+				return wcstoll(str->c_str(), nullptr, 10);
+			else if constexpr (std::is_same_v<T, float>)
+				return wcstof(str->c_str(), nullptr);
+			else
+				return wcstod(str->c_str(), nullptr);
+		}
+		if (const auto* b = std::get_if<bool>(value))
+			return static_cast<T>(*b);
+		if (const auto* i = std::get_if<int64>(value))
+			return static_cast<T>(*i);
 
-		if (!clients[client].charfilename.length())
-			return L"";
+		return static_cast<T>(std::get<double>(*value));
+	}
 
-		if (!clients[client].lines.contains(name))
-			return L"";
+	std::wstring GetCharacterIniString(ClientId client, CharacterIniKey key)
+	{
+		const auto* value = FindValue(client, key);
+		return value ? CharacterIniValueToString(*value) : L"";
+	}
 
-		auto line = clients[client].lines[name];
-		return line;
+	bool GetCharacterIniBool(ClientId client, CharacterIniKey key)
+	{
+		const auto* value = FindValue(client, key);
+		if (!value)
+			return false;
+
+		if (const auto* str = std::get_if<std::wstring>(value))
+			return *str == L"true" || *str == L"1";
+		if (const auto* b = std::get_if<bool>(value))
+			return *b;
+		if (const auto* i = std::get_if<int64>(value))
+			return *i != 0;
+
+		return std::get<double>(*value) != 0.0;
 	}
 
-	void SetCharacterIni(ClientId client, const std::wstring& name, std::wstring value) 
-	{ 
-		clients[client].lines[name] = std::move(value);
+	int GetCharacterIniInt(ClientId client, CharacterIniKey key) { return GetCharacterIniNumber<int>(client, key); }
+	uint GetCharacterIniUint(ClientId client, CharacterIniKey key) { return GetCharacterIniNumber<uint>(client, key); }
+	float GetCharacterIniFloat(ClientId client, CharacterIniKey key) { return GetCharacterIniNumber<float>(client, key); }
+	double GetCharacterIniDouble(ClientId client, CharacterIniKey key) { return GetCharacterIniNumber<double>(client, key); }
+	int64 GetCharacterIniInt64(ClientId client, CharacterIniKey key) { return GetCharacterIniNumber<int64>(client, key); }
+
+	void SetCharacterIni(ClientId client, CharacterIniKey key, std::wstring value) { SetValue(client, key, std::move(value)); }
+	void SetCharacterIniBool(ClientId client, CharacterIniKey key, bool value) { SetValue(client, key, value); }
+	void SetCharacterIniInt64(ClientId client, CharacterIniKey key, int64 value) { SetValue(client, key, value); }
+	void SetCharacterIniDouble(ClientId client, CharacterIniKey key, double value) { SetValue(client, key, value); }
+
+	std::wstring GetCharacterIniString(ClientId client, const std::wstring& name)
+	{
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniString(client, *key) : L"";
 	}
 
+	void SetCharacterIni(ClientId client, const std::wstring& name, std::wstring value) { SetValue(client, InternCharacterIniKey(name), std::move(value)); }
+
 	bool GetCharacterIniBool(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return val == L"true" || val == L"1";
+		const auto key = FindCharacterIniKey(name);
+		return key && GetCharacterIniBool(client, *key);
 	}
 
 	int GetCharacterIniInt(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return wcstol(val.c_str(), nullptr, 10);
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniInt(client, *key) : 0;
 	}
 
 	uint GetCharacterIniUint(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return wcstoul(val.c_str(), nullptr, 10);
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniUint(client, *key) : 0;
 	}
 
 	float GetCharacterIniFloat(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return wcstof(val.c_str(), nullptr);
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniFloat(client, *key) : 0.0f;
 	}
 
 	double GetCharacterIniDouble(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return wcstod(val.c_str(), nullptr);
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniDouble(client, *key) : 0.0;
 	}
 
 	int64 GetCharacterIniInt64(ClientId client, const std::wstring& name)
 	{
-		const auto val = GetCharacterIniString(client, name);
-		return wcstoll(val.c_str(), nullptr, 10);
+		const auto key = FindCharacterIniKey(name);
+		return key ? GetCharacterIniInt64(client, *key) : 0;
 	}
 } // namespace Hk::Ini
\ No newline at end of file
@@ -60,7 +60,7 @@ namespace Hk::Message
 
 		// for all players in system...
 
-		for (auto player : Hk::Client::getAllPlayersInSystem(systemId))
+		for (uint player = Hk::Client::GetFirstPlayerInSystem(systemId); player; player = Hk::Client::GetNextPlayerInSystem(player))
 		{
 			const CHAT_ID ciClient = {player};
 			IServerImplHook::SubmitChat(ci, ret, buffer, ciClient, -1);
@@ -88,25 +88,290 @@ namespace Hk::Message
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	cpp::result<void, Error> FMsgEncodeXML(const std::wstring& xmlString, char* buffer, uint size, uint& ret)
+	cpp::result<void, Error> EncodeXMLParsed(const std::wstring& xmlString, char* buffer, uint size, uint& ret)
 	{
+		static const std::wstring header = L"<?xml version=\"1.0\" encoding=\"UTF-16\"?><RDL><PUSH/>";
+		static const std::wstring footer = L"<PARA/><POP/></RDL>\x000A\x000A";
+
+		std::wstring wscMsg;
+		wscMsg.reserve(header.length() + xmlString.length() + footer.length());
+		wscMsg += header;
+		wscMsg += xmlString;
+		wscMsg += footer;
+
 		XMLReader rdr;
 		RenderDisplayList rdl;
-		std::wstring wscMsg = L"<?xml version=\"1.0\" encoding=\"UTF-16\"?><RDL><PUSH/>";
-		wscMsg += xmlString;
-		wscMsg += L"<PARA/><POP/></RDL>\x000A\x000A";
 		if (!rdr.read_buffer(rdl, (const char*)wscMsg.c_str(), wscMsg.length() * 2))
 			return cpp::fail(Error::WrongXmlSyntax);
 
 		BinaryRDLWriter rdlwrite;
 		rdlwrite.write_buffer(rdl, buffer, size, ret);
+
+		return {};
+	}
+
+	std::optional<std::vector<char>> EncodeXMLParsed(const std::wstring& xmlString)
+	{
+		static char buffer[0xFFFF];
+		uint size;
+		if (EncodeXMLParsed(xmlString, buffer, sizeof(buffer), size).has_error() || size > sizeof(buffer))
+			return std::nullopt;
+
+		return std::vector<char>(buffer, buffer + size);
+	}
+
+	// Nearly every formatted message is a fixed framing, a TRA style and the TEXT tags, around a single run of text. The binary form
+	// of a framing is derived once by encoding it around probe texts and comparing the results. Afterwards a message only needs its
+	// text copied between the encoded prefix and suffix and the length fields patched that depend on it.
+	struct EncodeTemplate
+	{
+		//! A little endian 32 bit value that grows with the length of the text
+		struct LengthField
+		{
+			bool inSuffix;
+			uint offset;
+			uint base;
+			uint perChar;
+		};
+
+		bool usable = false;
+		std::vector<char> prefix;
+		std::vector<char> suffix;
+		std::vector<LengthField> lengthFields;
+		//! Real messages that are still encoded through the XML path as well and compared before the template is trusted on its own
+		uint uncheckedUses = 8;
+	};
+
+	struct TextSlot
+	{
+		std::wstring_view prefix;
+		std::wstring_view text;
+		std::wstring_view suffix;
+	};
+
+	constexpr size_t MaxEncodeTemplates = 256;
+	std::unordered_map<std::wstring, EncodeTemplate> encodeTemplates;
+	bool encodeTemplatesEnabled = true;
+
+	// Only text that the XML reader takes over unchanged can be spliced in. Entities, markup, control characters and whitespace at
+	// either end, which the reader may normalise, go through the XML path.
+	std::optional<TextSlot> FindTextSlot(std::wstring_view xml)
+	{
+		constexpr std::wstring_view open = L"<TEXT>";
+		constexpr std::wstring_view close = L"</TEXT>";
+
+		const auto start = xml.find(open);
+		if (start == std::wstring_view::npos || xml.find(open, start + 1) != std::wstring_view::npos)
+			return std::nullopt;
+
+		const auto textStart = start + open.length();
+		const auto end = xml.find(close, textStart);
+		if (end == std::wstring_view::npos)
+			return std::nullopt;
+
+		const auto text = xml.substr(textStart, end - textStart);
+		if (text.empty() || text.front() == L' ' || text.back() == L' ')
+			return std::nullopt;
+
+		if (std::ranges::any_of(text, [](wchar_t c) { return c < L' ' || c == L'<' || c == L'>' || c == L'&'; }))
+			return std::nullopt;
+
+		return TextSlot {xml.substr(0, textStart), text, xml.substr(end)};
+	}
+
+	uint ReadUint(const std::vector<char>& bytes, size_t offset)
+	{
+		uint value;
+		std::memcpy(&value, bytes.data() + offset, sizeof(value));
+		return value;
+	}
+
+	// Returns the number of bytes written, or 0 if the message does not fit the buffer
+	uint ApplyTemplate(const EncodeTemplate& encodeTemplate, std::wstring_view text, char* buffer, uint size)
+	{
+		const size_t textBytes = text.length() * sizeof(wchar_t);
+		const size_t total = encodeTemplate.prefix.size() + textBytes + encodeTemplate.suffix.size();
+		if (total > size)
+			return 0;
+
+		char* suffix = buffer + encodeTemplate.prefix.size() + textBytes;
+		std::memcpy(buffer, encodeTemplate.prefix.data(), encodeTemplate.prefix.size());
+		std::memcpy(buffer + encodeTemplate.prefix.size(), text.data(), textBytes);
+		std::memcpy(suffix, encodeTemplate.suffix.data(), encodeTemplate.suffix.size());
+
+		for (const auto& field : encodeTemplate.lengthFields)
+		{
+			const uint value = field.base + field.perChar * static_cast<uint>(text.length());
+			std::memcpy((field.inSuffix ? suffix : buffer) + field.offset, &value, sizeof(value));
+		}
+
+		return static_cast<uint>(total);
+	}
+
+	// Collects the length fields of one part of the encoded framing by comparing its encodings around two probes one character apart
+	bool FindLengthFields(const std::vector<char>& first, const std::vector<char>& second, size_t start, size_t length, bool inSuffix, uint firstLength,
+	    EncodeTemplate& encodeTemplate)
+	{
+		const size_t secondStart = inSuffix ? start + sizeof(wchar_t) : start;
+		for (size_t i = 0; i < length; i++)
+		{
+			if (first[start + i] == second[secondStart + i])
+				continue;
+
+			// A small difference always changes the lowest byte, so the first differing byte is where a little endian field starts
+			if (i + sizeof(uint) > length)
+				return false;
+
+			const uint perChar = ReadUint(second, secondStart + i) - ReadUint(first, start + i);
+			encodeTemplate.lengthFields.push_back({inSuffix, static_cast<uint>(i), ReadUint(first, start + i) - perChar * firstLength, perChar});
+			i += sizeof(uint) - 1;
+		}
+
+		return true;
+	}
+
+	EncodeTemplate BuildTemplate(std::wstring_view prefix, std::wstring_view suffix)
+	{
+		EncodeTemplate encodeTemplate;
+
+		const std::wstring probes[] = {L"FLHookProbeText", L"FLHookProbeTextX", std::wstring(L"FLHookProbeText") + std::wstring(300, L'Y')};
+		std::vector<char> encoded[std::size(probes)];
+		for (size_t i = 0; i < std::size(probes); i++)
+		{
+			auto result = EncodeXMLParsed(std::wstring(prefix) + probes[i] + std::wstring(suffix));
+			if (!result)
+				return encodeTemplate;
+			encoded[i] = std::move(result.value());
+		}
+
+		// Find where the text lands, the shorter probe is the start of the others
+		const auto* probeBytes = reinterpret_cast<const char*>(probes[0].data());
+		const size_t probeLength = probes[0].length() * sizeof(wchar_t);
+		const auto found = std::search(encoded[0].begin(), encoded[0].end(), probeBytes, probeBytes + probeLength);
+		if (found == encoded[0].end() || std::search(found + 1, encoded[0].end(), probeBytes, probeBytes + probeLength) != encoded[0].end())
+			return encodeTemplate;
+
+		const size_t prefixLength = found - encoded[0].begin();
+		const size_t suffixLength = encoded[0].size() - prefixLength - probeLength;
+		if (encoded[1].size() != encoded[0].size() + sizeof(wchar_t) ||
+		    std::memcmp(encoded[1].data() + prefixLength, probes[1].data(), probes[1].length() * sizeof(wchar_t)))
+			return encodeTemplate;
+
+		const auto firstLength = static_cast<uint>(probes[0].length());
+		if (!FindLengthFields(encoded[0], encoded[1], 0, prefixLength, false, firstLength, encodeTemplate) ||
+		    !FindLengthFields(encoded[0], encoded[1], prefixLength + probeLength, suffixLength, true, firstLength, encodeTemplate))
+			return encodeTemplate;
+
+		encodeTemplate.prefix.assign(encoded[0].begin(), encoded[0].begin() + prefixLength);
+		encodeTemplate.suffix.assign(encoded[0].end() - suffixLength, encoded[0].end());
+
+		// The long probe carries the length fields over a byte boundary, which confirms their width
+		std::vector<char> check(encoded[2].size());
+		encodeTemplate.usable = ApplyTemplate(encodeTemplate, probes[2], check.data(), check.size()) == check.size() && check == encoded[2];
+		return encodeTemplate;
+	}
+
+	EncodeTemplate* GetTemplate(const TextSlot& slot)
+	{
+		std::wstring framing;
+		framing.reserve(slot.prefix.length() + slot.suffix.length());
+		framing += slot.prefix;
+		framing += slot.suffix;
+
+		if (const auto existing = encodeTemplates.find(framing); existing != encodeTemplates.end())
+			return &existing->second;
+
+		if (encodeTemplates.size() >= MaxEncodeTemplates)
+			return nullptr;
+
+		return &encodeTemplates.emplace(std::move(framing), BuildTemplate(slot.prefix, slot.suffix)).first->second;
+	}
+
+	cpp::result<void, Error> FMsgEncodeXML(const std::wstring& xmlString, char* buffer, uint size, uint& ret)
+	{
+		const auto slot = encodeTemplatesEnabled ? FindTextSlot(xmlString) : std::optional<TextSlot>();
+		auto* encodeTemplate = slot ? GetTemplate(*slot) : nullptr;
+		if (!encodeTemplate || !encodeTemplate->usable)
+			return EncodeXMLParsed(xmlString, buffer, size, ret);
+
+		const uint written = ApplyTemplate(*encodeTemplate, slot->text, buffer, size);
+		if (!written)
+			return EncodeXMLParsed(xmlString, buffer, size, ret);
+
+		if (encodeTemplate->uncheckedUses)
+		{
+			encodeTemplate->uncheckedUses--;
+			const auto expected = EncodeXMLParsed(xmlString);
+			if (!expected || expected->size() != written || std::memcmp(expected->data(), buffer, written))
+			{
+				AddLog(LogType::Normal,
+				    LogLevel::Warn,
+				    std::format("Encoded message template differs from the XML reader, falling back for: {}", wstos(std::wstring(slot->prefix))));
+				encodeTemplate->usable = false;
+				return EncodeXMLParsed(xmlString, buffer, size, ret);
+			}
+		}
+
+		ret = written;
 		return {};
 	}
 
+	bool CheckEncodeTemplates()
+	{
+		const auto& style = FLHookConfig::c()->messages.msgStyle;
+		const std::vector<std::pair<std::wstring, std::wstring>> framings = {
+		    {L"<TRA data=\"0x19BD3A00\" mask=\"-1\"/><TEXT>", L"</TEXT>"},
+		    {L"<TRA data=\"0xE6C68400\" mask=\"-1\"/><TEXT>", L"</TEXT>"},
+		    {L"<TRA font=\"1\" color=\"#FFFFFF\"/><TEXT>", L"</TEXT>"},
+		    {std::format(L"<TRA data=\"{}\" mask=\"-1\"/><TEXT>", style.userCmdStyle), L"</TEXT>"},
+		    {std::format(L"<TRA data=\"{}\" mask=\"-1\"/> <TEXT>", style.deathMsgStyle), L"</TEXT>"},
+		    {L"<TEXT>", L"</TEXT>"},
+		};
+		const std::vector<std::wstring> texts = {
+		    L"x",
+		    L"Your client-id: 12",
+		    L"Death: Trent was killed by Juni (Missile/Torpedo)",
+		    L"\u00C4rger \u00FCber \u00D6l, \u0416\u0438\u0437\u043D\u044C \u65E5\u672C \U0001F680",
+		    std::wstring(255, L'a'),
+		    std::wstring(256, L'b'),
+		    std::wstring(4000, L'c'),
+		};
+
+		static char buffer[0xFFFF];
+		for (const auto& [prefix, suffix] : framings)
+		{
+			for (const auto& text : texts)
+			{
+				const std::wstring xml = prefix + text + suffix;
+				const auto expected = EncodeXMLParsed(xml);
+				const auto slot = FindTextSlot(xml);
+				auto* encodeTemplate = slot ? GetTemplate(*slot) : nullptr;
+				if (!expected || !encodeTemplate)
+					continue;
+
+				const uint written = encodeTemplate->usable ? ApplyTemplate(*encodeTemplate, slot->text, buffer, sizeof(buffer)) : 0;
+				if (encodeTemplate->usable && (written != expected->size() || std::memcmp(buffer, expected->data(), written)))
+				{
+					encodeTemplatesEnabled = false;
+					encodeTemplates.clear();
+					AddLog(LogType::Normal, LogLevel::Warn, std::format("Encoded message templates disabled, output differs for: {}", wstos(xml)));
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+	BroadcastStats broadcastStats;
+
 	void FMsgSendChat(ClientId client, char* buffer, uint size)
 	{
+		broadcastStats.packets++;
+		broadcastStats.bytes += size;
+
 		auto p4 = (uint)buffer;
 		uint p3 = size;
 		uint p2 = 0x00010000;
@@ -125,6 +390,52 @@ namespace Hk::Message
 
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+	cpp::result<EncodedMessage, Error> EncodeXML(const std::wstring& xml)
+	{
+		static char buffer[0xFFFF];
+		uint size;
+		if (const auto err = FMsgEncodeXML(xml, buffer, sizeof(buffer), size); err.has_error())
+			return cpp::fail(err.error());
+
+		return EncodedMessage {std::make_shared<const std::vector<char>>(buffer, buffer + size)};
+	}
+
+	void Broadcast(const EncodedMessage& message, const std::vector<uint>& clients)
+	{
+		if (!message.payload)
+			return;
+
+		// The payload is only read while sending, FMsgSendChat just lacks the const
+		auto* buffer = const_cast<char*>(message.payload->data());
+		for (const uint client : clients)
+			FMsgSendChat(client, buffer, message.GetSize());
+	}
+
+	void BroadcastToSystem(const EncodedMessage& message, uint systemId)
+	{
+		if (!message.payload)
+			return;
+
+		auto* buffer = const_cast<char*>(message.payload->data());
+		for (uint player = Hk::Client::GetFirstPlayerInSystem(systemId); player; player = Hk::Client::GetNextPlayerInSystem(player))
+			FMsgSendChat(player, buffer, message.GetSize());
+	}
+
+	void BroadcastToAll(const EncodedMessage& message)
+	{
+		if (!message.payload)
+			return;
+
+		auto* buffer = const_cast<char*>(message.payload->data());
+		PlayerData* playerDb = nullptr;
+		while ((playerDb = Players.traverse_active(playerDb)))
+			FMsgSendChat(playerDb->iOnlineId, buffer, message.GetSize());
+	}
+
+	BroadcastStats GetBroadcastStats() { return broadcastStats; }
+
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 	cpp::result<void, Error> FMsg(ClientId client, const std::wstring& xmlString)
 	{
 		char szBuf[0xFFFF];
@@ -160,18 +471,11 @@ namespace Hk::Message
 		{
 			systemId = std::get<uint>(system);
 		}
-		// encode xml std::string
-		char szBuf[0xFFFF];
-		uint iRet;
-		if (const auto err = FMsgEncodeXML(xmlString, szBuf, sizeof(szBuf), iRet); err.has_error())
-			return cpp::fail(err.error());
-
-		// for all players in system...
-		for (auto player : Hk::Client::getAllPlayersInSystem(systemId))
-		{
-			FMsgSendChat(player, szBuf, iRet);
-		}
+		const auto message = EncodeXML(xmlString);
+		if (message.has_error())
+			return cpp::fail(message.error());
 
+		BroadcastToSystem(message.value(), systemId);
 		return {};
 	}
 
@@ -179,21 +483,11 @@ namespace Hk::Message
 
 	cpp::result<void, Error> FMsgU(const std::wstring& xmlString)
 	{
-		// encode xml std::string
-		char szBuf[0xFFFF];
-		uint iRet;
-		const auto err = FMsgEncodeXML(xmlString, szBuf, sizeof(szBuf), iRet);
-		if (err.has_error())
-			return cpp::fail(err.error());
-
-		// for all players
-		PlayerData* playerDb = nullptr;
-		while ((playerDb = Players.traverse_active(playerDb)))
-		{
-			ClientId client = playerDb->iOnlineId;
-			FMsgSendChat(client, szBuf, iRet);
-		}
+		const auto message = EncodeXML(xmlString);
+		if (message.has_error())
+			return cpp::fail(message.error());
 
+		BroadcastToAll(message.value());
 		return {};
 	}
 
@@ -202,18 +496,9 @@ namespace Hk::Message
 	refuses to send if necessary. */
 	cpp::result<void, Error> FormatSendChat(uint toClientId, const std::wstring& sender, const std::wstring& text, const std::wstring& textColor)
 	{
-#define HAS_FLAG(a, b) ((a).wscFlags.find(b) != -1)
-
-		if (FLHookConfig::i()->userCommands.userCmdIgnore)
-		{
-			for (const auto& ignore : ClientInfo[toClientId].lstIgnore)
-			{
-				if (!HAS_FLAG(ignore, L"i") && !(ToLower(sender).compare(ToLower(ignore.character))))
-					return {}; // ignored
-				else if (HAS_FLAG(ignore, L"i") && (ToLower(sender).find(ToLower(ignore.character)) != -1))
-					return {}; // ignored
-			}
-		}
+		// The channel is not known here, so entries limited to private chat apply as well
+		if (FLHookConfig::i()->userCommands.userCmdIgnore && ClientInfoCold[toClientId].ignoreList.IsIgnored(sender, true))
+			return {};
 
 		uchar cFormat;
 		// adjust chatsize
@@ -271,14 +556,8 @@ namespace Hk::Message
 			return {};
 		}
 
-		if (FLHookConfig::i()->userCommands.userCmdIgnore)
-		{
-			for (auto const& ignore : ClientInfo[toClientId].lstIgnore)
-			{
-				if (HAS_FLAG(ignore, L"p"))
-					return {};
-			}
-		}
+		if (FLHookConfig::i()->userCommands.userCmdIgnore && ClientInfoCold[toClientId].ignoreList.IsIgnored(wscSender.value(), true))
+			return {};
 
 		// Send the message to both the sender and receiver.
 		auto err = FormatSendChat(toClientId, wscSender.value(), text, L"19BD3A");
@@ -302,7 +581,7 @@ namespace Hk::Message
 		pub::Player::GetSystem(fromClientId, systemId);
 
 		// For all players in system...
-		for (auto player : Hk::Client::getAllPlayersInSystem(systemId))
+		for (uint player = Hk::Client::GetFirstPlayerInSystem(systemId); player; player = Hk::Client::GetNextPlayerInSystem(player))
 		{
 			// Send the message a player in this system.
 			FormatSendChat(player, wscSender, text, L"E6C684");
@@ -337,7 +616,7 @@ namespace Hk::Message
 		pub::SpaceObj::GetLocation(iFromShip, vFromShipLoc, mFromShipDir);
 
 		// For all players in system...
-		for (auto player : Hk::Client::getAllPlayersInSystem(systemId))
+		for (uint player = Hk::Client::GetFirstPlayerInSystem(systemId); player; player = Hk::Client::GetNextPlayerInSystem(player))
 		{
 			uint ship;
 			pub::Player::GetShip(player, ship);
@@ -1,5 +1,8 @@
 #include "Global.hpp"
 #include "Features/TempBan.hpp"
+#include "Features/SaveScheduler.hpp"
+#include "Features/PlayerGrid.hpp"
+#include "Features/CharacterIndex.hpp"
 
 
 namespace Hk::Player
@@ -53,6 +56,10 @@ namespace Hk::Player
 		if (!player.index())
 			return cpp::fail(Error::InvalidClientId);
 
+		// The index is validated against the file, so this avoids decoding the character file for the common case
+		if (const auto character = CharacterIndex::i()->GetCharacter(std::get<std::wstring>(player)); character.has_value())
+			return static_cast<uint>(character.value().money);
+
 		const auto acc = Hk::Client::GetAccountByCharName(std::get<std::wstring>(player));
 		if (acc.has_error())
 			return cpp::fail(acc.error());
@@ -148,7 +155,7 @@ namespace Hk::Player
 		{ // money fix in case player logs in with this account
 			bool bFound = false;
 			std::wstring characterLower = ToLower(character);
-			for (auto& money : ClientInfo[client].lstMoneyFix)
+			for (auto& money : ClientInfoCold[client].lstMoneyFix)
 			{
 				if (money.character == characterLower)
 				{
@@ -163,7 +170,7 @@ namespace Hk::Player
 				MONEY_FIX mf;
 				mf.character = characterLower;
 				mf.uAmount = iAmount;
-				ClientInfo[client].lstMoneyFix.push_back(mf);
+				ClientInfoCold[client].lstMoneyFix.push_back(mf);
 			}
 		}
 
@@ -189,6 +196,9 @@ namespace Hk::Player
 		if (client == UINT_MAX)
 			return cpp::fail(Error::PlayerNotLoggedIn);
 
+		// Queued saves would otherwise be lost if the game does not save on the forced logout
+		SaveScheduler::i()->FlushClient(client);
+
 		CAccount* acc = Players.FindAccountFromClientID(client);
 		acc->ForceLogout();
 		return {};
@@ -339,6 +349,8 @@ namespace Hk::Player
 		pub::Save(client, 1);
 		WriteProcMem(pJmp, szTestAlAl, sizeof(szTestAlAl)); // restore
 
+		SaveScheduler::i()->MarkSaved(client);
+
 		return {};
 	}
 
@@ -556,9 +568,14 @@ namespace Hk::Player
 			Hk::Client::LockAccountAccess(acc, true); // also kicks player on this account
 			Players.DeleteCharacterFromName(str);
 			Hk::Client::UnlockAccountAccess(acc);
+			CharacterIndex::i()->RemoveCharacter(oldCharName);
 			return {};
 		}
 
+		// The file is copied below, so it has to be current before the player is kicked
+		if (client != UINT_MAX)
+			SaveScheduler::i()->SaveNow(client);
+
 		Hk::Client::LockAccountAccess(acc, true); // kick player if online
 		Hk::Client::UnlockAccountAccess(acc);
 
@@ -659,6 +676,9 @@ namespace Hk::Player
 		if (!FLHookConfig::i()->general.disableCharfileEncryption && !FlcEncodeFile(scNewCharfilePath.c_str(), scNewCharfilePath.c_str()))
 			return cpp::fail(Error::CouldNotEncodeCharFile);
 
+		CharacterIndex::i()->RemoveCharacter(oldCharName);
+		CharacterIndex::i()->UpdateFromFile(wscAccountDirname, newFileName.value());
+
 		return {};
 	}
 
@@ -1129,24 +1149,9 @@ namespace Hk::Player
 		uint iSystem;
 		pub::Player::GetSystem(client, iSystem);
 
-		// For all players in system...
-		PlayerData* playerDb = nullptr;
-		while ((playerDb = Players.traverse_active(playerDb)))
+		// For all players in space within the specified range of the sending char...
+		for (const uint client2 : PlayerGrid::c()->QueryRadius(iSystem, pos, fDistance))
 		{
-			// Get the this player's current system and location in the system.
-			ClientId client2 = playerDb->iOnlineId;
-			uint iSystem2 = 0;
-			pub::Player::GetSystem(client2, iSystem2);
-			if (iSystem != iSystem2)
-				continue;
-
-			uint ship2;
-			pub::Player::GetShip(client2, ship2);
-
-			Vector pos2;
-			Matrix rot2;
-			pub::SpaceObj::GetLocation(ship2, pos2, rot2);
-
 			// Ignore players who are in your group.
 			bool bGrouped = false;
 			for (auto& gm : lstMembers.value())
@@ -1157,11 +1162,7 @@ namespace Hk::Player
 					break;
 				}
 			}
-			if (bGrouped)
-				continue;
-
-			// Is player within the specified range of the sending char.
-			if (Hk::Math::Distance3D(pos, pos2) < fDistance)
+			if (!bGrouped)
 				return true;
 		}
 		return false;
@@ -1602,6 +1603,8 @@ namespace Hk::Player
 		BYTE patch[] = {0x90, 0x90};
 		WriteProcMem((char*)hModServer + 0x7EFA8, patch, sizeof(patch));
 		pub::Save(client, 1);
+
+		SaveScheduler::i()->MarkSaved(client);
 	}
 
 	cpp::result<const ShipId, Error> GetTarget(const std::variant<uint, std::wstring>& player)
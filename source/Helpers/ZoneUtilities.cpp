@@ -1,5 +1,7 @@
 ﻿#include "Global.hpp"
 
+#include <xmmintrin.h>
+
 namespace Hk::ZoneUtilities
 {
 
@@ -12,6 +14,53 @@ namespace Hk::ZoneUtilities
 	/** A map of system id to JumpPoint info */
 	std::multimap<uint, JumpPoint> JumpPoints;
 
+	/** A zone prepared for point queries. The transform has the zone size folded in so that a point is inside
+	 the zone if the squared length of the transformed point is at most 1. */
+	struct ZoneVolume
+	{
+		float transform[4][3];
+		Vector min;
+		Vector max;
+		Vector center;
+		/** The position of the zone in allZones, the first matching zone in that order wins */
+		uint order;
+		const Zone* zone;
+	};
+
+	struct ZoneNode
+	{
+		Vector min;
+		Vector max;
+		/** For leaves the range in volumes, for inner nodes start is the index of the right child and count is 0 */
+		uint start;
+		uint count;
+	};
+
+	/** The zones of one system with their size scaled transforms in structure of arrays layout, used by batched queries.
+	 Zones without volume get a transform that moves every point to infinity so they never match. */
+	struct ZoneColumns
+	{
+		std::array<std::vector<float>, 12> transform;
+		std::vector<const Zone*> zones;
+	};
+
+	/** A bounding volume hierarchy over the zones of one system */
+	struct ZoneTree
+	{
+		std::vector<ZoneVolume> volumes;
+		std::vector<ZoneNode> nodes;
+		ZoneColumns columns;
+	};
+
+	/** A map of system id to the zone hierarchy of that system, rebuilt whenever allZones is read */
+	std::unordered_map<uint, ZoneTree> zoneTrees;
+
+	/** Incremented whenever allZones is read, so zone indices handed out before can be recognised as stale. Starts at 1 after the first
+	 read, a default constructed ZoneMembership never matches. */
+	uint universeGeneration = 0;
+
+	constexpr uint MaxZonesPerLeaf = 4;
+
 	/** Multiply mat1 by mat2 and return the result */
 	static TransformMatrix MultiplyMatrix(const TransformMatrix& mat1, const TransformMatrix& mat2)
 	{
@@ -121,6 +170,434 @@ namespace Hk::ZoneUtilities
 		return tm;
 	}
 
+	static float GetAxis(const Vector& v, int axis) { return axis == 0 ? v.x : axis == 1 ? v.y : v.z; }
+
+	static ZoneVolume CreateZoneVolume(const Zone& lz, uint order)
+	{
+		ZoneVolume volume {};
+		const float scale[3] = {1.0f / lz.size.x, 1.0f / lz.size.y, 1.0f / lz.size.z};
+		for (int row = 0; row < 4; row++)
+			for (int col = 0; col < 3; col++)
+				volume.transform[row][col] = lz.transform.d[row][col] * scale[col];
+
+		// The rotation part maps world axes onto zone axes, so the extent of the ellipsoid along world axis i
+		// is the length of the row i scaled by the zone size
+		float extent[3];
+		for (int i = 0; i < 3; i++)
+		{
+			const float x = lz.transform.d[i][0] * lz.size.x;
+			const float y = lz.transform.d[i][1] * lz.size.y;
+			const float z = lz.transform.d[i][2] * lz.size.z;
+			extent[i] = std::sqrt(x * x + y * y + z * z);
+		}
+
+		volume.min = {lz.pos.x - extent[0], lz.pos.y - extent[1], lz.pos.z - extent[2]};
+		volume.max = {lz.pos.x + extent[0], lz.pos.y + extent[1], lz.pos.z + extent[2]};
+		volume.center = lz.pos;
+		volume.order = order;
+		volume.zone = &lz;
+		return volume;
+	}
+
+	static bool IsInsideVolume(const ZoneVolume& volume, const Vector& pos)
+	{
+		const auto& m = volume.transform;
+		const float x = pos.x * m[0][0] + pos.y * m[1][0] + pos.z * m[2][0] + m[3][0];
+		const float y = pos.x * m[0][1] + pos.y * m[1][1] + pos.z * m[2][1] + m[3][1];
+		const float z = pos.x * m[0][2] + pos.y * m[1][2] + pos.z * m[2][2] + m[3][2];
+		return x * x + y * y + z * z <= 1.0f;
+	}
+
+	static bool IsInsideBounds(const Vector& min, const Vector& max, const Vector& pos)
+	{
+		return pos.x >= min.x && pos.x <= max.x && pos.y >= min.y && pos.y <= max.y && pos.z >= min.z && pos.z <= max.z;
+	}
+
+	/** Build the node for volumes [start, end) and its children, splitting on the longest axis of the zone centers */
+	static void BuildZoneNode(ZoneTree& tree, uint start, uint end)
+	{
+		const auto nodeIndex = static_cast<uint>(tree.nodes.size());
+		tree.nodes.emplace_back();
+
+		Vector min = tree.volumes[start].min;
+		Vector max = tree.volumes[start].max;
+		Vector centerMin = tree.volumes[start].center;
+		Vector centerMax = tree.volumes[start].center;
+		for (uint i = start + 1; i < end; i++)
+		{
+			const auto& volume = tree.volumes[i];
+			min = {std::min(min.x, volume.min.x), std::min(min.y, volume.min.y), std::min(min.z, volume.min.z)};
+			max = {std::max(max.x, volume.max.x), std::max(max.y, volume.max.y), std::max(max.z, volume.max.z)};
+			centerMin = {std::min(centerMin.x, volume.center.x), std::min(centerMin.y, volume.center.y), std::min(centerMin.z, volume.center.z)};
+			centerMax = {std::max(centerMax.x, volume.center.x), std::max(centerMax.y, volume.center.y), std::max(centerMax.z, volume.center.z)};
+		}
+
+		tree.nodes[nodeIndex].min = min;
+		tree.nodes[nodeIndex].max = max;
+
+		if (end - start <= MaxZonesPerLeaf)
+		{
+			tree.nodes[nodeIndex].start = start;
+			tree.nodes[nodeIndex].count = end - start;
+			return;
+		}
+
+		const Vector spread = {centerMax.x - centerMin.x, centerMax.y - centerMin.y, centerMax.z - centerMin.z};
+		const int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : spread.y >= spread.z ? 1 : 2;
+
+		const uint mid = start + (end - start) / 2;
+		std::nth_element(tree.volumes.begin() + start,
+		    tree.volumes.begin() + mid,
+		    tree.volumes.begin() + end,
+		    [axis](const ZoneVolume& a, const ZoneVolume& b) { return GetAxis(a.center, axis) < GetAxis(b.center, axis); });
+
+		// The left child always directly follows its parent
+		BuildZoneNode(tree, start, mid);
+		tree.nodes[nodeIndex].start = static_cast<uint>(tree.nodes.size());
+		tree.nodes[nodeIndex].count = 0;
+		BuildZoneNode(tree, mid, end);
+	}
+
+	static void BuildZoneTrees()
+	{
+		zoneTrees.clear();
+
+		uint order = 0;
+		for (const auto& [systemId, lz] : allZones)
+		{
+			auto& tree = zoneTrees[systemId];
+			auto& columns = tree.columns;
+			columns.zones.emplace_back(&lz);
+
+			// A zone without volume never contains a point
+			if (lz.size.x == 0 || lz.size.y == 0 || lz.size.z == 0)
+			{
+				for (int i = 0; i < 12; i++)
+					columns.transform[i].emplace_back(i < 9 ? 0.0f : std::numeric_limits<float>::infinity());
+				order++;
+				continue;
+			}
+
+			const auto& volume = tree.volumes.emplace_back(CreateZoneVolume(lz, order++));
+			for (int row = 0; row < 4; row++)
+				for (int col = 0; col < 3; col++)
+					columns.transform[row * 3 + col].emplace_back(volume.transform[row][col]);
+		}
+
+		for (auto& [_, tree] : zoneTrees)
+		{
+			if (!tree.volumes.empty())
+				BuildZoneNode(tree, 0, static_cast<uint>(tree.volumes.size()));
+		}
+	}
+
+	/** Find the first zone in allZones order that contains pos and matches the predicate */
+	template<typename Predicate>
+	static const Zone* FindZone(uint system, const Vector& pos, Predicate predicate)
+	{
+		const auto tree = zoneTrees.find(system);
+		if (tree == zoneTrees.end() || tree->second.nodes.empty())
+			return nullptr;
+
+		const ZoneVolume* found = nullptr;
+		uint stack[64];
+		uint stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize)
+		{
+			const auto& node = tree->second.nodes[stack[--stackSize]];
+			if (!IsInsideBounds(node.min, node.max, pos))
+				continue;
+
+			if (node.count)
+			{
+				for (uint i = node.start; i < node.start + node.count; i++)
+				{
+					const auto& volume = tree->second.volumes[i];
+					if ((!found || volume.order < found->order) && IsInsideBounds(volume.min, volume.max, pos) && IsInsideVolume(volume, pos) &&
+					    predicate(*volume.zone))
+						found = &volume;
+				}
+				continue;
+			}
+
+			const uint left = static_cast<uint>(&node - tree->second.nodes.data()) + 1;
+			stack[stackSize++] = node.start;
+			stack[stackSize++] = left;
+		}
+
+		return found ? found->zone : nullptr;
+	}
+
+	constexpr const char* UniverseIni = "..\\data\\universe\\universe.ini";
+	constexpr char UniverseCacheMagic[4] = {'F', 'L', 'U', 'C'};
+	constexpr uint UniverseCacheVersion = 1;
+
+	/** The files read while parsing the universe, their sizes and write times validate the binary cache */
+	static std::vector<std::string> universeSourceFiles;
+
+	static void RecordSourceFile(const std::string& path) { universeSourceFiles.emplace_back(path); }
+
+	struct SourceFileStamp
+	{
+		int64 size;
+		int64 writeTime;
+	};
+
+	static SourceFileStamp GetSourceFileStamp(const std::string& path)
+	{
+		// Missing files are recorded as well, creating one of them invalidates the cache
+		std::error_code ec;
+		const auto size = std::filesystem::file_size(path, ec);
+		if (ec)
+			return {-1, 0};
+
+		const auto time = std::filesystem::last_write_time(path, ec);
+		return {static_cast<int64>(size), ec ? 0 : static_cast<int64>(time.time_since_epoch().count())};
+	}
+
+	static std::string GetUniverseCachePath()
+	{
+		char dataPath[MAX_PATH];
+		GetUserDataPath(dataPath);
+		return std::string(dataPath) + "\\universe.cache";
+	}
+
+	class CacheWriter
+	{
+		std::string data;
+
+	  public:
+		template<typename T>
+		    requires std::is_trivially_copyable_v<T>
+		void Write(const T& value)
+		{
+			data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		void Write(const std::string& str)
+		{
+			Write(static_cast<uint>(str.size()));
+			data.append(str);
+		}
+
+		const std::string& GetData() const { return data; }
+	};
+
+	class CacheReader
+	{
+		const char* pos;
+		const char* end;
+
+	  public:
+		explicit CacheReader(const std::string& data) : pos(data.data()), end(data.data() + data.size()) {}
+
+		template<typename T>
+		    requires std::is_trivially_copyable_v<T>
+		void Read(T& value)
+		{
+			if (static_cast<size_t>(end - pos) < sizeof(T))
+				throw std::out_of_range("Universe cache is truncated");
+
+			memcpy(&value, pos, sizeof(T));
+			pos += sizeof(T);
+		}
+
+		void Read(std::string& str)
+		{
+			uint size;
+			Read(size);
+			if (static_cast<size_t>(end - pos) < size)
+				throw std::out_of_range("Universe cache is truncated");
+
+			str.assign(pos, size);
+			pos += size;
+		}
+	};
+
+	static void SaveUniverseCache(const std::multimap<uint, LootableZone, std::less<>>& lootableZones)
+	{
+		CacheWriter writer;
+		writer.Write(UniverseCacheMagic);
+		writer.Write(UniverseCacheVersion);
+
+		writer.Write(static_cast<uint>(universeSourceFiles.size()));
+		for (const auto& file : universeSourceFiles)
+		{
+			const auto stamp = GetSourceFileStamp(file);
+			writer.Write(file);
+			writer.Write(stamp.size);
+			writer.Write(stamp.writeTime);
+		}
+
+		writer.Write(static_cast<uint>(mapSystems.size()));
+		for (const auto& [_, system] : mapSystems)
+		{
+			writer.Write(system.sysNick);
+			writer.Write(system.systemId);
+			writer.Write(system.scale);
+		}
+
+		writer.Write(static_cast<uint>(allZones.size()));
+		for (const auto& [_, zone] : allZones)
+		{
+			writer.Write(zone.sysNick);
+			writer.Write(zone.zoneNick);
+			writer.Write(zone.systemId);
+			writer.Write(zone.transform);
+			writer.Write(zone.size);
+			writer.Write(zone.pos);
+			writer.Write(zone.damage);
+			writer.Write(zone.encounter);
+		}
+
+		writer.Write(static_cast<uint>(JumpPoints.size()));
+		for (const auto& [_, jump] : JumpPoints)
+		{
+			writer.Write(jump.sysNick);
+			writer.Write(jump.jumpNick);
+			writer.Write(jump.jumpDestSysNick);
+			writer.Write(jump.System);
+			writer.Write(jump.jumpId);
+			writer.Write(jump.jumpDestSysId);
+		}
+
+		writer.Write(static_cast<uint>(lootableZones.size()));
+		for (const auto& [_, zone] : lootableZones)
+		{
+			writer.Write(zone.zoneNick);
+			writer.Write(zone.systemId);
+			writer.Write(zone.lootNick);
+			writer.Write(zone.iLootId);
+			writer.Write(zone.iCrateId);
+			writer.Write(zone.iMinLoot);
+			writer.Write(zone.iMaxLoot);
+			writer.Write(zone.iLootDifficulty);
+			writer.Write(zone.size);
+			writer.Write(zone.pos);
+		}
+
+		std::ofstream file(GetUniverseCachePath(), std::ios::binary | std::ios::trunc);
+		file.write(writer.GetData().data(), writer.GetData().size());
+		if (!file)
+			Console::ConWarn("Unable to write the universe cache");
+	}
+
+	/** Load the parsed universe from the binary cache, fails if the cache is missing, outdated or any source file changed */
+	static bool LoadUniverseCache(std::multimap<uint, LootableZone, std::less<>>& lootableZones)
+	{
+		std::ifstream file(GetUniverseCachePath(), std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+
+		// Read the whole cache at once
+		std::string data(static_cast<size_t>(file.tellg()), '\0');
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		if (!file)
+			return false;
+
+		try
+		{
+			CacheReader reader(data);
+
+			char magic[4];
+			uint version;
+			reader.Read(magic);
+			reader.Read(version);
+			if (memcmp(magic, UniverseCacheMagic, sizeof(magic)) != 0 || version != UniverseCacheVersion)
+				return false;
+
+			uint count;
+			reader.Read(count);
+			std::vector<std::string> sourceFiles(count);
+			for (auto& path : sourceFiles)
+			{
+				SourceFileStamp stamp {};
+				reader.Read(path);
+				reader.Read(stamp.size);
+				reader.Read(stamp.writeTime);
+
+				if (const auto current = GetSourceFileStamp(path); current.size != stamp.size || current.writeTime != stamp.writeTime)
+					return false;
+			}
+
+			std::map<uint, SystemInfo> systems;
+			reader.Read(count);
+			for (uint i = 0; i < count; i++)
+			{
+				SystemInfo system;
+				reader.Read(system.sysNick);
+				reader.Read(system.systemId);
+				reader.Read(system.scale);
+				systems[system.systemId] = system;
+			}
+
+			std::multimap<uint, Zone> zones;
+			reader.Read(count);
+			for (uint i = 0; i < count; i++)
+			{
+				Zone zone;
+				reader.Read(zone.sysNick);
+				reader.Read(zone.zoneNick);
+				reader.Read(zone.systemId);
+				reader.Read(zone.transform);
+				reader.Read(zone.size);
+				reader.Read(zone.pos);
+				reader.Read(zone.damage);
+				reader.Read(zone.encounter);
+				zones.insert({zone.systemId, zone});
+			}
+
+			std::multimap<uint, JumpPoint> jumpPoints;
+			reader.Read(count);
+			for (uint i = 0; i < count; i++)
+			{
+				JumpPoint jump;
+				reader.Read(jump.sysNick);
+				reader.Read(jump.jumpNick);
+				reader.Read(jump.jumpDestSysNick);
+				reader.Read(jump.System);
+				reader.Read(jump.jumpId);
+				reader.Read(jump.jumpDestSysId);
+				jumpPoints.insert({jump.System, jump});
+			}
+
+			std::multimap<uint, LootableZone, std::less<>> lootable;
+			reader.Read(count);
+			for (uint i = 0; i < count; i++)
+			{
+				LootableZone zone;
+				reader.Read(zone.zoneNick);
+				reader.Read(zone.systemId);
+				reader.Read(zone.lootNick);
+				reader.Read(zone.iLootId);
+				reader.Read(zone.iCrateId);
+				reader.Read(zone.iMinLoot);
+				reader.Read(zone.iMaxLoot);
+				reader.Read(zone.iLootDifficulty);
+				reader.Read(zone.size);
+				reader.Read(zone.pos);
+				lootable.insert({zone.systemId, zone});
+			}
+
+			// Only replace the loaded data once the whole cache was read successfully
+			universeSourceFiles = std::move(sourceFiles);
+			for (auto& [systemId, system] : systems)
+				mapSystems[systemId] = std::move(system);
+			allZones = std::move(zones);
+			JumpPoints = std::move(jumpPoints);
+			lootableZones = std::move(lootable);
+		}
+		catch (const std::out_of_range&)
+		{
+			return false;
+		}
+
+		Console::ConInfo(std::format("Loaded {} systems and {} zones from the universe cache", mapSystems.size(), allZones.size()));
+		return true;
+	}
+
 	/**
 	Parse the specified ini file (usually in the data/solar/asteriods) and retrieve
 	the lootable zone details.
@@ -131,6 +608,8 @@ namespace Hk::ZoneUtilities
 		std::string path = "..\\data\\";
 		path += file;
 
+		RecordSourceFile(path);
+
 		INI_Reader ini;
 		if (ini.open(path.c_str(), false))
 		{
@@ -205,6 +684,8 @@ namespace Hk::ZoneUtilities
 		std::string path = "..\\data\\universe\\";
 		path += file;
 
+		RecordSourceFile(path);
+
 		INI_Reader ini;
 		if (ini.open(path.c_str(), false))
 		{
@@ -235,6 +716,8 @@ namespace Hk::ZoneUtilities
 		std::string path = "..\\data\\universe\\";
 		path += file;
 
+		RecordSourceFile(path);
+
 		INI_Reader ini;
 		if (ini.open(path.c_str(), false))
 		{
@@ -345,15 +828,15 @@ namespace Hk::ZoneUtilities
 		}
 	}
 
-	/** Read all systems in the universe ini */
-	void ZoneUtilities::ReadUniverse(std::multimap<uint, LootableZone, std::less<>>* zones)
+	/** Parse all systems in the universe ini */
+	static void ParseUniverse(std::multimap<uint, LootableZone, std::less<>>* zones)
 	{
-		allZones.clear();
+		RecordSourceFile(UniverseIni);
 
 		// Read all system ini files again this time extracting zone size/postion
 		// information for the zone list.
 		INI_Reader ini;
-		if (ini.open("..\\data\\universe\\universe.ini", false))
+		if (ini.open(UniverseIni, false))
 		{
 			while (ini.read_header())
 			{
@@ -386,7 +869,7 @@ namespace Hk::ZoneUtilities
 
 		// Read all system ini files again this time extracting zone size/postion
 		// information for the lootable zone list.
-		if (ini.open("..\\data\\universe\\universe.ini", false))
+		if (ini.open(UniverseIni, false))
 		{
 			while (ini.read_header())
 			{
@@ -407,6 +890,46 @@ namespace Hk::ZoneUtilities
 			}
 			ini.close();
 		}
+
+	}
+
+	/** Read all systems in the universe ini, from the binary cache if none of the source files changed */
+	void ZoneUtilities::ReadUniverse(std::multimap<uint, LootableZone, std::less<>>* zones)
+	{
+		allZones.clear();
+		JumpPoints.clear();
+
+		std::multimap<uint, LootableZone, std::less<>> lootableZones;
+		if (!LoadUniverseCache(lootableZones))
+		{
+			universeSourceFiles.clear();
+			ParseUniverse(&lootableZones);
+			SaveUniverseCache(lootableZones);
+		}
+
+		if (zones)
+		{
+			// Like the ini parsing always did, a zone the caller already has is not added again, only its position and size are refreshed
+			std::unordered_map<std::string, LootableZone*> existing;
+			for (auto& [_, zone] : *zones)
+				existing.try_emplace(zone.zoneNick, &zone);
+
+			for (const auto& [systemId, zone] : lootableZones)
+			{
+				if (const auto known = existing.find(zone.zoneNick); known != existing.end())
+				{
+					known->second->pos = zone.pos;
+					known->second->size = zone.size;
+				}
+				else
+				{
+					existing.try_emplace(zone.zoneNick, &zones->insert({systemId, zone})->second);
+				}
+			}
+		}
+
+		BuildZoneTrees();
+		universeGeneration++;
 	}
 
 	/**
@@ -415,31 +938,12 @@ namespace Hk::ZoneUtilities
 	*/
 	bool ZoneUtilities::InZone(uint system, const Vector& pos, Zone& rlz)
 	{
-		// For each zone in the system test that pos is inside the
-		// zone.
-		auto start = allZones.lower_bound(system);
-		auto end = allZones.upper_bound(system);
-		for (auto i = start; i != end; ++i)
-		{
-			const Zone& lz = i->second;
-			/** Transform the point pos onto coordinate system defined by matrix m
-			 */
-			float x = pos.x * lz.transform.d[0][0] + pos.y * lz.transform.d[1][0] + pos.z * lz.transform.d[2][0] + lz.transform.d[3][0];
-			float y = pos.x * lz.transform.d[0][1] + pos.y * lz.transform.d[1][1] + pos.z * lz.transform.d[2][1] + lz.transform.d[3][1];
-			float z = pos.x * lz.transform.d[0][2] + pos.y * lz.transform.d[1][2] + pos.z * lz.transform.d[2][2] + lz.transform.d[3][2];
-
-			// If r is less than/equal to 1 then the point is inside the ellipsoid.
-			float result = sqrt(powf(x / lz.size.x, 2) + powf(y / lz.size.y, 2) + powf(z / lz.size.z, 2));
-			if (result <= 1)
-			{
-				rlz = lz;
-				return true;
-			}
-		}
+		const Zone* zone = FindZone(system, pos, [](const Zone&) { return true; });
+		if (!zone)
+			return false;
 
-		// Return the iterator. If the iter is allZones.end() then the point
-		// is not in a lootable zone.
-		return false;
+		rlz = *zone;
+		return true;
 	}
 
 	/**
@@ -448,32 +952,94 @@ namespace Hk::ZoneUtilities
 	*/
 	bool ZoneUtilities::InDeathZone(uint system, const Vector& pos, Zone& rlz)
 	{
-		// For each zone in the system test that pos is inside the
-		// zone.
-		auto start = allZones.lower_bound(system);
-		auto end = allZones.upper_bound(system);
-		for (auto i = start; i != end; ++i)
+		const Zone* zone = FindZone(system, pos, [](const Zone& lz) { return lz.damage > 250; });
+		if (!zone)
+			return false;
+
+		rlz = *zone;
+		return true;
+	}
+
+	/**
+	 Test a batch of positions in one system against all of its zones at once. For every position the membership
+	 contains one bit per zone, four positions are transformed per instruction.
+	*/
+	void ZoneUtilities::InZones(uint system, const ZonePositions& positions, ZoneMembership& membership)
+	{
+		membership.systemId = system;
+		membership.generation = universeGeneration;
+		membership.zoneCount = 0;
+		membership.masks.clear();
+		membership.wordsPerPosition = 0;
+
+		const auto tree = zoneTrees.find(system);
+		if (tree == zoneTrees.end())
+			return;
+
+		const auto& columns = tree->second.columns;
+		const size_t count = positions.Size();
+		membership.zoneCount = columns.zones.size();
+		membership.wordsPerPosition = (columns.zones.size() + 63) / 64;
+		membership.masks.assign(count * membership.wordsPerPosition, 0);
+
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (size_t zone = 0; zone < columns.zones.size(); zone++)
 		{
-			const Zone& lz = i->second;
+			__m128 m[12];
+			for (int i = 0; i < 12; i++)
+				m[i] = _mm_set1_ps(columns.transform[i][zone]);
+
+			const size_t word = zone / 64;
+			const uint64 bit = 1ULL << (zone % 64);
 
-			/** Transform the point pos onto coordinate system defined by matrix m
-			 */
-			float x = pos.x * lz.transform.d[0][0] + pos.y * lz.transform.d[1][0] + pos.z * lz.transform.d[2][0] + lz.transform.d[3][0];
-			float y = pos.x * lz.transform.d[0][1] + pos.y * lz.transform.d[1][1] + pos.z * lz.transform.d[2][1] + lz.transform.d[3][1];
-			float z = pos.x * lz.transform.d[0][2] + pos.y * lz.transform.d[1][2] + pos.z * lz.transform.d[2][2] + lz.transform.d[3][2];
+			size_t pos = 0;
+			for (; pos + 4 <= count; pos += 4)
+			{
+				const __m128 px = _mm_loadu_ps(&positions.x[pos]);
+				const __m128 py = _mm_loadu_ps(&positions.y[pos]);
+				const __m128 pz = _mm_loadu_ps(&positions.z[pos]);
+
+				// Summed left to right like the scalar tail and IsInsideVolume, so a position gets the same answer in every lane
+				const __m128 x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m[0]), _mm_mul_ps(py, m[3])), _mm_mul_ps(pz, m[6])), m[9]);
+				const __m128 y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m[1]), _mm_mul_ps(py, m[4])), _mm_mul_ps(pz, m[7])), m[10]);
+				const __m128 z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, m[2]), _mm_mul_ps(py, m[5])), _mm_mul_ps(pz, m[8])), m[11]);
+				const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+
+				const int inside = _mm_movemask_ps(_mm_cmple_ps(distance, one));
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (inside & (1 << lane))
+						membership.masks[(pos + lane) * membership.wordsPerPosition + word] |= bit;
+				}
+			}
 
-			// If r is less than/equal to 1 then the point is inside the ellipsoid.
-			float result = sqrt(powf(x / lz.size.x, 2) + powf(y / lz.size.y, 2) + powf(z / lz.size.z, 2));
-			if (result <= 1 && lz.damage > 250)
+			for (; pos < count; pos++)
 			{
-				rlz = lz;
-				return true;
+				const float px = positions.x[pos];
+				const float py = positions.y[pos];
+				const float pz = positions.z[pos];
+				const float x = px * columns.transform[0][zone] + py * columns.transform[3][zone] + pz * columns.transform[6][zone] + columns.transform[9][zone];
+				const float y = px * columns.transform[1][zone] + py * columns.transform[4][zone] + pz * columns.transform[7][zone] + columns.transform[10][zone];
+				const float z = px * columns.transform[2][zone] + py * columns.transform[5][zone] + pz * columns.transform[8][zone] + columns.transform[11][zone];
+				if (x * x + y * y + z * z <= 1.0f)
+					membership.masks[pos * membership.wordsPerPosition + word] |= bit;
 			}
 		}
+	}
+
+	/**
+	 Return the zone a bit of a batched query result refers to, or nullptr if the universe was read again since the query ran.
+	*/
+	const Zone* ZoneUtilities::GetMembershipZone(const ZoneMembership& membership, size_t zone)
+	{
+		if (membership.generation != universeGeneration || zone >= membership.zoneCount)
+			return nullptr;
+
+		const auto tree = zoneTrees.find(membership.systemId);
+		if (tree == zoneTrees.end() || zone >= tree->second.columns.zones.size())
+			return nullptr;
 
-		// Return the iterator. If the iter is allZones.end() then the point
-		// is not in a death zone.
-		return false;
+		return tree->second.columns.zones[zone];
 	}
 
 	/**
@@ -1,6 +1,10 @@
 #include "Global.hpp"
 #include "Features/Mail.hpp"
 #include "Features/TempBan.hpp"
+#include "Features/SaveScheduler.hpp"
+#include "Features/CharacterIndex.hpp"
+#include "Features/PlayerGrid.hpp"
+#include "Features/AdminRights.hpp"
 
 #include <random>
 
@@ -50,6 +54,8 @@ namespace IServerImplHook
 	    {TimerNPCAndF1Check, 50},
 	    {TimerCheckResolveResults, 0},
 	    {TimerTempBanCheck, 15000},
+	    {TimerProcessSaveQueue, 0},
+	    {TimerRefreshAdminRights, 15000},
 	};
 
 	void Update__Inner()
@@ -177,11 +183,7 @@ namespace IServerImplHook
 			else if (buffer[0] == '.')
 			{
 				const CAccount* acc = Players.FindAccountFromClientID(cidFrom.iId);
-				std::wstring accDirname = Hk::Client::GetAccountDirName(acc);
-				std::string adminFile = CoreGlobals::c()->accPath + wstos(accDirname) + "\\flhookadmin.ini";
-				WIN32_FIND_DATA fd;
-				HANDLE hFind = FindFirstFile(adminFile.c_str(), &fd);
-				if (hFind != INVALID_HANDLE_VALUE)
+				if (const auto rights = AdminRights::i()->Get(Hk::Client::GetAccountDirName(acc)))
 				{
 					if (FLHookConfig::c()->messages.echoCommands)
 					{
@@ -190,8 +192,7 @@ namespace IServerImplHook
 						Hk::Message::FMsg(cidFrom.iId, XML);
 					}
 
-					FindClose(hFind);
-					g_Admin.ReadRights(adminFile);
+					g_Admin.SetRightsByString(*rights);
 					g_Admin.client = cidFrom.iId;
 					g_Admin.wscAdminName = ToWChar(Players.GetActiveCharacterName(cidFrom.iId));
 					g_Admin.ExecuteCommandString(buffer.data() + 1);
@@ -199,61 +200,65 @@ namespace IServerImplHook
 				}
 			}
 
-			std::wstring eventString;
-			eventString.reserve(256);
-			eventString = L"chat";
-			eventString += L" from=";
-			if (cidFrom.iId == SpecialChatIds::CONSOLE)
-				eventString += L"console";
-			else
+			// Building the event string is only worth it if something listens
+			if (HasEventSubscribers())
 			{
-				const auto* fromName = ToWChar(Players.GetActiveCharacterName(cidFrom.iId));
-				if (!fromName)
-					eventString += L"unknown";
+				std::wstring eventString;
+				eventString.reserve(256);
+				eventString = L"chat";
+				eventString += L" from=";
+				if (cidFrom.iId == SpecialChatIds::CONSOLE)
+					eventString += L"console";
 				else
-					eventString += fromName;
-			}
+				{
+					const auto* fromName = ToWChar(Players.GetActiveCharacterName(cidFrom.iId));
+					if (!fromName)
+						eventString += L"unknown";
+					else
+						eventString += fromName;
+				}
 
-			eventString += L" id=";
-			eventString += std::to_wstring(cidFrom.iId);
+				eventString += L" id=";
+				eventString += std::to_wstring(cidFrom.iId);
 
-			eventString += L" type=";
-			if (cidTo.iId == SpecialChatIds::UNIVERSE)
-				eventString += L"universe";
-			else if (cidTo.iId == SpecialChatIds::GROUP)
-			{
-				eventString += L"group";
-				eventString += L" grpidto=";
-				eventString += std::to_wstring(Players.GetGroupID(cidFrom.iId));
-			}
-			else if (cidTo.iId == SpecialChatIds::SYSTEM)
-				eventString += L"system";
-			else if (cidTo.iId == SpecialChatIds::LOCAL)
-				eventString += L"local";
-			else
-			{
-				eventString += L"player";
-				eventString += L" to=";
-
-				if (cidTo.iId == SpecialChatIds::CONSOLE)
-					eventString += L"console";
+				eventString += L" type=";
+				if (cidTo.iId == SpecialChatIds::UNIVERSE)
+					eventString += L"universe";
+				else if (cidTo.iId == SpecialChatIds::GROUP)
+				{
+					eventString += L"group";
+					eventString += L" grpidto=";
+					eventString += std::to_wstring(Players.GetGroupID(cidFrom.iId));
+				}
+				else if (cidTo.iId == SpecialChatIds::SYSTEM)
+					eventString += L"system";
+				else if (cidTo.iId == SpecialChatIds::LOCAL)
+					eventString += L"local";
 				else
 				{
-					const auto* toName = ToWChar(Players.GetActiveCharacterName(cidTo.iId));
-					if (!toName)
-						eventString += L"unknown";
+					eventString += L"player";
+					eventString += L" to=";
+
+					if (cidTo.iId == SpecialChatIds::CONSOLE)
+						eventString += L"console";
 					else
-						eventString += toName;
+					{
+						const auto* toName = ToWChar(Players.GetActiveCharacterName(cidTo.iId));
+						if (!toName)
+							eventString += L"unknown";
+						else
+							eventString += toName;
+					}
+
+					eventString += L" idto=";
+					eventString += std::to_wstring(cidTo.iId);
 				}
 
-				eventString += L" idto=";
-				eventString += std::to_wstring(cidTo.iId);
+				eventString += L" text=";
+				eventString += buffer;
+				ProcessEvent(L"{}", eventString.c_str());
 			}
 
-			eventString += L" text=";
-			eventString += buffer;
-			ProcessEvent(L"{}", eventString.c_str());
-
 			// check if chat should be suppressed for in-built command prefixes
 			if (buffer[0] == L'/' || buffer[0] == L'.')
 			{
@@ -271,15 +276,8 @@ namespace IServerImplHook
 			}
 
 			// Check if any other custom prefixes have been added
-			if (!config->general.chatSuppressList.empty())
-			{
-				auto lcBuffer = ToLower(buffer);
-				for (const auto& chat : config->general.chatSuppressList)
-				{
-					if (lcBuffer.rfind(chat, 0) == 0)
-						return false;
-				}
-			}
+			if (config->general.chatSuppressMatcher.Matches(buffer))
+				return false;
 		}
 		CATCH_HOOK({})
 
@@ -290,7 +288,8 @@ namespace IServerImplHook
 	{
 		TRY_HOOK
 		{
-			ClientInfo[client].ship = shipId;
+			Hk::Client::SetClientShip(client, shipId);
+			Hk::Client::UpdatePlayerSystem(client);
 			ClientInfo[client].bCruiseActivated = false;
 			ClientInfo[client].bThrusterActivated = false;
 			ClientInfo[client].bEngineKilled = false;
@@ -299,12 +298,12 @@ namespace IServerImplHook
 			// adjust cash, this is necessary when cash was added while use was in
 			// charmenu/had other char selected
 			std::wstring charName = ToLower(ToWChar(Players.GetActiveCharacterName(client)));
-			for (const auto& i : ClientInfo[client].lstMoneyFix)
+			for (const auto& i : ClientInfoCold[client].lstMoneyFix)
 			{
 				if (i.character == charName)
 				{
 					Hk::Player::AddCash(charName, i.uAmount);
-					ClientInfo[client].lstMoneyFix.remove(i);
+					ClientInfoCold[client].lstMoneyFix.remove(i);
 					break;
 				}
 			}
@@ -368,12 +367,14 @@ namespace IServerImplHook
 			return false;
 		}
 
+		PlayerGrid::i()->Update(client, Players[client].systemId, ui.vPos);
 		return true;
 	}
 
 	void LaunchComplete__Inner(uint, uint shipId) {TRY_HOOK {ClientId client = Hk::Client::GetClientIdByShip(shipId).value();
 	if (client)
 	{
+		PlayerGrid::i()->UpdateFromShip(client);
 		ClientInfo[client].tmSpawnTime = Hk::Time::GetUnixMiliseconds(); // save for anti-dockkill
 		                                             // is there spawnprotection?
 		if (FLHookConfig::i()->general.antiDockKill > 0)
@@ -392,6 +393,9 @@ CATCH_HOOK({})
 std::wstring g_CharBefore;
 bool CharacterSelect__Inner(const CHARACTER_ID& cid, ClientId client)
 {
+	// Write any queued save for the previous character before the game switches to the new one
+	SaveScheduler::i()->FlushClient(client);
+
 	try
 	{
 		const wchar_t* charName = ToWChar(Players.GetActiveCharacterName(client));
@@ -415,6 +419,8 @@ void CharacterSelect__InnerAfter(const CHARACTER_ID& cId, unsigned int client)
 	TRY_HOOK
 	{
 		std::wstring charName = ToWChar(Players.GetActiveCharacterName(client));
+		Hk::Client::SetClientCharacterName(client, charName);
+		Hk::Client::UpdatePlayerSystem(client);
 
 		if (g_CharBefore.compare(charName) != 0)
 		{
@@ -480,15 +486,18 @@ void BaseEnter__InnerAfter(uint baseId, ClientId client)
 {
 	TRY_HOOK
 	{
+		Hk::Client::UpdatePlayerSystem(client);
+		PlayerGrid::i()->Remove(client);
+
 		// adjust cash, this is necessary when cash was added while use was in
 		// charmenu/had other char selected
 		std::wstring charName = ToLower(ToWChar(Players.GetActiveCharacterName(client)));
-		for (const auto& i : ClientInfo[client].lstMoneyFix)
+		for (const auto& i : ClientInfoCold[client].lstMoneyFix)
 		{
 			if (i.character == charName)
 			{
 				Hk::Player::AddCash(charName, i.uAmount);
-				ClientInfo[client].lstMoneyFix.remove(i);
+				ClientInfoCold[client].lstMoneyFix.remove(i);
 				break;
 			}
 		}
@@ -731,9 +740,13 @@ void DisConnect__Inner(ClientId client, EFLConnection)
 {
 	if (client <= MaxClientId && client > 0 && !ClientInfo[client].bDisconnected)
 	{
-		IEngineHook::playerShips.erase(Players[client].shipId);
+		SaveScheduler::i()->FlushClient(client);
+		Hk::Client::SetClientCharacterName(client, L"");
+		Hk::Client::SetPlayerSystem(client, 0);
+		PlayerGrid::i()->Remove(client);
+		IEngineHook::playerShips.Erase(Players[client].shipId);
 		ClientInfo[client].bDisconnected = true;
-		ClientInfo[client].lstMoneyFix.clear();
+		ClientInfoCold[client].lstMoneyFix.clear();
 		ClientInfo[client].iTradePartner = 0;
 
 		const auto* charName = ToWChar(Players.GetActiveCharacterName(client));
@@ -749,6 +762,9 @@ void JumpInComplete__InnerAfter(uint systemId, uint shipId)
 		if (client.has_error())
 			return;
 
+		Hk::Client::UpdatePlayerSystem(client.value());
+		PlayerGrid::i()->UpdateFromShip(client.value());
+
 		// event
 		ProcessEvent(L"jumpin char={} id={} system={}",
 		    ToWChar(Players.GetActiveCharacterName(client.value())),
@@ -762,6 +778,9 @@ void SystemSwitchOutComplete__InnerAfter(uint, ClientId client)
 {
 	TRY_HOOK
 	{
+		Hk::Client::UpdatePlayerSystem(client);
+		PlayerGrid::i()->Remove(client);
+
 		const auto system = Hk::Client::GetPlayerSystem(client);
 		ProcessEvent(L"switchout char={} id={} system={}", ToWChar(Players.GetActiveCharacterName(client)), client, system.value().c_str());
 	}
@@ -940,6 +959,14 @@ void Startup__InnerAfter(const SStartupInfo& si)
 
 	StartupCache::Done();
 
+	if (Hk::Message::CheckEncodeTemplates())
+		Console::ConInfo("Encoded message templates match the XML reader");
+
+	// Pick up character files that changed while the server was down, afterwards the save hook keeps the index current
+	CharacterIndex::i()->Build();
+
+	Console::ConInfo(std::format("Loaded the rights of {} admin accounts", AdminRights::i()->Load()));
+
 	Console::ConInfo("FLHook Ready");
 
 	CoreGlobals::i()->flhookReady = true;
@@ -3941,7 +3968,7 @@ namespace IServerImplHook
 {
 	void __stdcall BaseEnter(uint baseId, ClientId client)
 	{
-		IEngineHook::playerShips.erase(Players[client].shipId);
+		IEngineHook::playerShips.Erase(Players[client].shipId);
 		AddLog(LogType::Normal, LogLevel::Debug, std::format("BaseEnter(\n\tuint baseId = {}\n\tClientId client = {}\n)", baseId, client));
 
 		auto skip = CallPluginsBefore<void>(HookedCall::IServerImpl__BaseEnter, baseId, client);
@@ -4273,7 +4300,7 @@ namespace IServerImplHook
 		}
 		PlayerLaunch__InnerAfter(shipId, client);
 
-		IEngineHook::playerShips.insert(shipId);
+		IEngineHook::playerShips.Insert(shipId);
 
 		CallPluginsAfter(HookedCall::IServerImpl__PlayerLaunch, shipId, client);
 	}
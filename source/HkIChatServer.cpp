@@ -4,8 +4,6 @@
 called when chat-text is being sent to a player, we reformat it(/set chatfont)
 **************************************************************************************************************/
 
-#define HAS_FLAG(a, b) ((a).wscFlags.find(b) != -1)
-
 void __stdcall SendChat(ClientId client, ClientId clientTo, uint size, void* rdl)
 {
 	CallPluginsBefore(HookedCall::IChat__SendChat, client, clientTo, size, rdl);
@@ -26,18 +24,10 @@ void __stdcall SendChat(ClientId client, ClientId clientTo, uint size, void* rdl
 			const int spaceAfterColonOffset = buffer[sender.length() + 1] == ' ' ? sender.length() + 2 : 0;
 			const std::wstring text = buffer.substr(spaceAfterColonOffset, buffer.length() - spaceAfterColonOffset);
 
-			if (FLHookConfig::i()->userCommands.userCmdIgnore && ((clientTo & 0xFFFF) != 0))
-			{ // check ignores
-				for (const auto& ci : ClientInfo[client].lstIgnore)
-				{
-					if (HAS_FLAG(ci, L"p") && (clientTo & 0x10000))
-						continue; // no privchat
-					else if (!HAS_FLAG(ci, L"i") && !(ToLower(sender).compare(ToLower(ci.character))))
-						return; // ignored
-					else if (HAS_FLAG(ci, L"i") && (ToLower(sender).find(ToLower(ci.character)) != -1))
-						return; // ignored
-				}
-			}
+			// check ignores, anything sent to a client id rather than a channel is private chat
+			if (FLHookConfig::i()->userCommands.userCmdIgnore && ((clientTo & 0xFFFF) != 0) &&
+			    ClientInfoCold[client].ignoreList.IsIgnored(sender, !(clientTo & 0x10000)))
+				return;
 
 			uchar format = 0x00;
 			if (FLHookConfig::i()->userCommands.userCmdSetChatFont)
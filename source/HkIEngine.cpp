@@ -235,9 +235,22 @@ abort_lbl:
 		CObject::Class objClass;
 	};
 
-	std::unordered_set<uint> playerShips;
-	std::unordered_map<uint, iobjCache> cacheSolarIObjs;
-	std::unordered_map<uint, iobjCache> cacheNonsolarIObjs;
+	struct IObjCache
+	{
+		FlatIdMap<iobjCache> objects;
+		uint64 hits = 0;
+		uint64 misses = 0;
+		uint64 evictions = 0;
+
+		[[nodiscard]] ObjectCacheStats GetStats() const { return { hits, misses, evictions, objects.Size(), objects.Capacity() }; }
+	};
+
+	FlatIdSet playerShips;
+	IObjCache cacheSolarIObjs;
+	IObjCache cacheNonsolarIObjs;
+
+	ObjectCacheStats GetSolarCacheStats() { return cacheSolarIObjs.GetStats(); }
+	ObjectCacheStats GetNonSolarCacheStats() { return cacheNonsolarIObjs.GetStats(); }
 
 	FARPROC FindStarListRet = FARPROC(0x6D0C846);
 
@@ -254,31 +267,31 @@ abort_lbl:
 		MetaListNode* node = FindIObjOnListFunc(starSystem->starSystem.shipList, searchedId);
 		if (node)
 		{
-			cacheNonsolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheNonsolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		node = FindIObjOnListFunc(starSystem->starSystem.lootList, searchedId);
 		if (node)
 		{
-			cacheNonsolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheNonsolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		node = FindIObjOnListFunc(starSystem->starSystem.guidedList, searchedId);
 		if (node)
 		{
-			cacheNonsolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheNonsolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		node = FindIObjOnListFunc(starSystem->starSystem.mineList, searchedId);
 		if (node)
 		{
-			cacheNonsolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheNonsolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		node = FindIObjOnListFunc(starSystem->starSystem.counterMeasureList, searchedId);
 		if (node)
 		{
-			cacheNonsolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheNonsolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		return nullptr;
@@ -289,13 +302,13 @@ abort_lbl:
 		MetaListNode* node = FindIObjOnListFunc(starSystem->starSystem.solarList, searchedId);
 		if (node)
 		{
-			cacheSolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheSolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		node = FindIObjOnListFunc(starSystem->starSystem.asteroidList, searchedId);
 		if (node)
 		{
-			cacheSolarIObjs[searchedId] = { node->value->starSystem, node->value->cobj->objectClass };
+			cacheSolarIObjs.objects.Insert(searchedId, { node->value->starSystem, node->value->cobj->objectClass });
 			return node->value;
 		}
 		return nullptr;
@@ -319,21 +332,23 @@ abort_lbl:
 
 		if (searchedId & 0x80000000) // check if solar
 		{
-			auto iter = cacheSolarIObjs.find(searchedId);
-			if (iter == cacheSolarIObjs.end())
+			const auto* cached = cacheSolarIObjs.objects.Find(searchedId);
+			if (!cached)
 			{
+				cacheSolarIObjs.misses++;
 				return FindSolar(starSystem, searchedId);
 			}
 
-			if (iter->second.cacheStarSystem != &starSystem->starSystem)
+			cacheSolarIObjs.hits++;
+			if (cached->cacheStarSystem != &starSystem->starSystem)
 			{
 				lastFoundItem = searchedId;
-				lastFoundInSystem = iter->second.cacheStarSystem;
+				lastFoundInSystem = cached->cacheStarSystem;
 				return nullptr;
 			}
 
 			MetaListNode* node;
-			switch (iter->second.objClass)
+			switch (cached->objClass)
 			{
 			case CObject::Class::CSOLAR_OBJECT:
 				node = FindIObjOnListFunc(starSystem->starSystem.solarList, searchedId);
@@ -353,23 +368,25 @@ abort_lbl:
 		}
 		else
 		{
-			if (!playerShips.count(searchedId)) // player can swap systems, for them search just the system's shiplist
+			if (!playerShips.Contains(searchedId)) // player can swap systems, for them search just the system's shiplist
 			{
-				auto iter = cacheNonsolarIObjs.find(searchedId);
-				if (iter == cacheNonsolarIObjs.end())
+				const auto* cached = cacheNonsolarIObjs.objects.Find(searchedId);
+				if (!cached)
 				{
+					cacheNonsolarIObjs.misses++;
 					return FindNonSolar(starSystem, searchedId);
 				}
 
-				if (iter->second.cacheStarSystem != &starSystem->starSystem)
+				cacheNonsolarIObjs.hits++;
+				if (cached->cacheStarSystem != &starSystem->starSystem)
 				{
 					lastFoundItem = searchedId;
-					lastFoundInSystem = iter->second.cacheStarSystem;
+					lastFoundInSystem = cached->cacheStarSystem;
 					return nullptr;
 				}
 
 				MetaListNode* node;
-				switch (iter->second.objClass)
+				switch (cached->objClass)
 				{
 				case CObject::Class::CSHIP_OBJECT:
 					node = FindIObjOnListFunc(starSystem->starSystem.shipList, searchedId);
@@ -437,13 +454,10 @@ abort_lbl:
 
 	void __stdcall GameObjectDestructor(uint id)
 	{
-		if (id & 0x80000000)
+		auto& cache = id & 0x80000000 ? cacheSolarIObjs : cacheNonsolarIObjs;
+		if (cache.objects.Erase(id))
 		{
-			cacheSolarIObjs.erase(id);
-		}
-		else
-		{
-			cacheNonsolarIObjs.erase(id);
+			cache.evictions++;
 		}
 	}
 
@@ -483,16 +497,47 @@ abort_lbl:
 		uint size;
 	};
 
-	std::unordered_map<CObject*, CObjNode*> CMineMap;
-	std::unordered_map<CObject*, CObjNode*> CCmMap;
-	std::unordered_map<CObject*, CObjNode*> CBeamMap;
-	std::unordered_map<CObject*, CObjNode*> CGuidedMap;
-	std::unordered_map<CObject*, CObjNode*> CSolarMap;
-	std::unordered_map<CObject*, CObjNode*> CShipMap;
-	std::unordered_map<CObject*, CObjNode*> CAsteroidMap;
-	std::unordered_map<CObject*, CObjNode*> CLootMap;
-	std::unordered_map<CObject*, CObjNode*> CEquipmentMap;
-	std::unordered_map<CObject*, CObjNode*> CObjectMap;
+	struct TrackedCObj
+	{
+		CObjNode* node;
+		CObject::Class objClass;
+	};
+
+	// The classes whose list nodes are tracked, in the order of liveCObjCounts
+	constexpr std::array<std::pair<CObject::Class, const char*>, 10> trackedCObjClasses = {{
+	    {CObject::CASTEROID_OBJECT, "asteroid"},
+	    {CObject::CEQUIPMENT_OBJECT, "equipment"},
+	    {CObject::COBJECT_MASK, "object"},
+	    {CObject::CSOLAR_OBJECT, "solar"},
+	    {CObject::CSHIP_OBJECT, "ship"},
+	    {CObject::CLOOT_OBJECT, "loot"},
+	    {CObject::CBEAM_OBJECT, "beam"},
+	    {CObject::CGUIDED_OBJECT, "guided"},
+	    {CObject::CCOUNTERMEASURE_OBJECT, "countermeasure"},
+	    {CObject::CMINE_OBJECT, "mine"},
+	}};
+
+	// Every tracked CObject with the node the game created for it in the list of its class
+	FlatIdMap<TrackedCObj, CObject*> trackedCObjs;
+	std::array<uint, trackedCObjClasses.size()> liveCObjCounts;
+
+	int GetTrackedCObjClassIndex(CObject::Class objClass)
+	{
+		for (size_t i = 0; i < trackedCObjClasses.size(); i++)
+		{
+			if (trackedCObjClasses[i].first == objClass)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	std::vector<std::pair<std::string, uint>> GetLiveObjectCounts()
+	{
+		std::vector<std::pair<std::string, uint>> counts;
+		for (size_t i = 0; i < trackedCObjClasses.size(); i++)
+			counts.emplace_back(trackedCObjClasses[i].second, liveCObjCounts[i]);
+		return counts;
+	}
 
 	std::unordered_map<uint, CSimple*> CAsteroidMap2;
 
@@ -514,49 +559,23 @@ abort_lbl:
 
 	void __fastcall CObjDestr(CObject* cobj)
 	{
-		std::unordered_map<CObject*, CObjNode*>* cobjMap;
-		switch (cobj->objectClass) {
-		case CObject::CASTEROID_OBJECT:
+		if (cobj->objectClass == CObject::CASTEROID_OBJECT)
 			CAsteroidMap2.erase(reinterpret_cast<CSimple*>(cobj)->id);
-			cobjMap = &CAsteroidMap;
-			break;
-		case CObject::CEQUIPMENT_OBJECT:
-			cobjMap = &CEquipmentMap;
-			break;
-		case CObject::COBJECT_MASK:
-			cobjMap = &CObjectMap;
-			break;
-		case CObject::CSOLAR_OBJECT:
-			cobjMap = &CSolarMap;
-			break;
-		case CObject::CSHIP_OBJECT:
-			cobjMap = &CShipMap;
-			break;
-		case CObject::CLOOT_OBJECT:
-			cobjMap = &CLootMap;
-			break;
-		case CObject::CBEAM_OBJECT:
-			cobjMap = &CBeamMap;
-			break;
-		case CObject::CGUIDED_OBJECT:
-			cobjMap = &CGuidedMap;
-			break;
-		case CObject::CCOUNTERMEASURE_OBJECT:
-			cobjMap = &CCmMap;
-			break;
-		case CObject::CMINE_OBJECT:
-			cobjMap = &CMineMap;
-			break;
-		}
 
-		auto item = cobjMap->find(cobj);
-		if (item != cobjMap->end())
-		{
-			CObjList* cobjList = CObjListFind(cobj->objectClass);
-			cobjMap->erase(item);
-			static uint dummy;
-			removeCObjNode(cobjList, &dummy, item->second);
-		}
+		const auto* item = trackedCObjs.Find(cobj);
+		if (!item)
+			return;
+
+		// Copy before erasing, erasing moves entries around in the table
+		const TrackedCObj tracked = *item;
+		trackedCObjs.Erase(cobj);
+
+		if (const int index = GetTrackedCObjClassIndex(tracked.objClass); index >= 0)
+			liveCObjCounts[index]--;
+
+		CObjList* cobjList = CObjListFind(tracked.objClass);
+		static uint dummy;
+		removeCObjNode(cobjList, &dummy, tracked.node);
 	}
 
 	uint CObjDestrRetAddr = 0x62AF447;
@@ -575,42 +594,21 @@ abort_lbl:
 	CObject* __cdecl CObjAllocDetour(CObject::Class objClass)
 	{
 		CSimple* retVal = CObjAllocCallOrig(objClass);
+		const int index = GetTrackedCObjClassIndex(objClass);
+		if (index < 0)
+			return retVal;
+
 		CObjList* cobjList = CObjListFind(objClass);
 
-		switch (objClass)
+		// The game may hand out the address of an object destroyed before FLHook saw it, possibly of another class. Move the count over
+		if (const auto* previous = trackedCObjs.Find(retVal))
 		{
-		case CObject::CASTEROID_OBJECT:
-			CAsteroidMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CEQUIPMENT_OBJECT:
-			CEquipmentMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::COBJECT_MASK:
-			CObjectMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CSOLAR_OBJECT:
-			CSolarMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CSHIP_OBJECT:
-			CShipMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CLOOT_OBJECT:
-			CLootMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CBEAM_OBJECT:
-			CBeamMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CGUIDED_OBJECT:
-			CGuidedMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CCOUNTERMEASURE_OBJECT:
-			CCmMap[retVal] = cobjList->entry->last;
-			break;
-		case CObject::CMINE_OBJECT:
-			CMineMap[retVal] = cobjList->entry->last;
-			break;
+			if (const int previousIndex = GetTrackedCObjClassIndex(previous->objClass); previousIndex >= 0)
+				liveCObjCounts[previousIndex]--;
 		}
+		liveCObjCounts[index]++;
 
+		trackedCObjs.Insert(retVal, { cobjList->entry->last, objClass });
 		return retVal;
 	}
 
@@ -137,7 +137,7 @@ void __stdcall AddDamageEntry(
 
 		if (g_DmgTo && subObjId == 1) // only save hits on the hull (subObjId=1)
 		{
-			ClientInfo[g_DmgTo].dmgLast = *dmgList;
+			ClientInfoCold[g_DmgTo].dmgLast = *dmgList;
 		}
 	}
 	CATCH_HOOK({})
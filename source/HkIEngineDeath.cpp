@@ -1,4 +1,5 @@
 ﻿#include "Global.hpp"
+#include "Features/PlayerGrid.hpp"
 
 std::wstring SetSizeToSmall(const std::wstring& wscDataFormat)
 {
@@ -13,46 +14,25 @@ void SendDeathMessage(const std::wstring& msg, uint systemId, ClientId clientVic
 {
 	CallPluginsBefore(HookedCall::IEngine__SendDeathMessage, msg, systemId, clientVictim, clientKiller);
 
-	// encode xml std::string(default and small)
-	// non-sys
-	std::wstring xmlMsg = L"<TRA data=\"" + FLHookConfig::i()->messages.msgStyle.deathMsgStyle + L"\" mask=\"-1\"/> <TEXT>";
-	xmlMsg += XMLText(msg);
-	xmlMsg += L"</TEXT>";
-
-	char xmlBuf[0xFFFF];
-	uint ret;
-	if(Hk::Message::FMsgEncodeXML(xmlMsg, xmlBuf, sizeof(xmlBuf), ret).has_error())
-		return;
-
-	std::wstring styleSmall = SetSizeToSmall(FLHookConfig::i()->messages.msgStyle.deathMsgStyle);
-	std::wstring xmlMsgSmall = std::wstring(L"<TRA data=\"") + styleSmall + L"\" mask=\"-1\"/> <TEXT>";
-	xmlMsgSmall += XMLText(msg);
-	xmlMsgSmall += L"</TEXT>";
-	char bufSmall[0xFFFF];
-	uint retSmall;
-	if (Hk::Message::FMsgEncodeXML(xmlMsgSmall, bufSmall, sizeof(bufSmall), retSmall).has_error())
-		return;
-
-	// sys
-	std::wstring xmlMsgSys = L"<TRA data=\"" + FLHookConfig::i()->messages.msgStyle.deathMsgStyleSys + L"\" mask=\"-1\"/> <TEXT>";
-	xmlMsgSys += XMLText(msg);
-	xmlMsgSys += L"</TEXT>";
-	char bufSys[0xFFFF];
-	uint retSys;
-	if (Hk::Message::FMsgEncodeXML(xmlMsgSys, bufSys, sizeof(bufSys), retSys).has_error())
-		return;
-
-	std::wstring styleSmallSys = SetSizeToSmall(FLHookConfig::i()->messages.msgStyle.deathMsgStyleSys);
-	std::wstring xmlMsgSmallSys = L"<TRA data=\"" + styleSmallSys + L"\" mask=\"-1\"/> <TEXT>";
-	xmlMsgSmallSys += XMLText(msg);
-	xmlMsgSmallSys += L"</TEXT>";
-	char szBufSmallSys[0xFFFF];
-	uint retSmallSys;
-	if (Hk::Message::FMsgEncodeXML(xmlMsgSmallSys, szBufSmallSys, sizeof(szBufSmallSys), retSmallSys).has_error())
-		return;
-
-	// send
-	// for all players
+	const auto* config = FLHookConfig::c();
+
+	// The message comes in four variants, default and small size for players in other systems and in the system of the death.
+	// Players are sorted into them first, so only the variants someone receives are encoded, and each is encoded once.
+	enum DeathMsgVariant
+	{
+		Default,
+		Small,
+		DefaultSys,
+		SmallSys,
+		VariantCount
+	};
+
+	// Reused between deaths, in large battles this runs many times per second
+	static std::array<std::vector<uint>, VariantCount> recipients;
+	static std::vector<char> buffer(0xFFFF);
+	for (auto& list : recipients)
+		list.clear();
+
 	PlayerData* playerData = nullptr;
 	while ((playerData = Players.traverse_active(playerData)))
 	{
@@ -60,49 +40,42 @@ void SendDeathMessage(const std::wstring& msg, uint systemId, ClientId clientVic
 		uint clientSystemId = 0;
 		pub::Player::GetSystem(client, clientSystemId);
 
-		char* sendXmlBuf;
-		int sendXmlRet;
-		char* sendXmlBufSys;
-		int sendXmlSysRet;
-		if (FLHookConfig::i()->userCommands.userCmdSetDieMsgSize && (ClientInfo[client].dieMsgSize == CS_SMALL))
-		{
-			sendXmlBuf = bufSmall;
-			sendXmlRet = retSmall;
-			sendXmlBufSys = szBufSmallSys;
-			sendXmlSysRet = retSmallSys;
+		bool sendSys;
+		if (!config->userCommands.userCmdSetDieMsg)
+		{ // /set diemsg disabled, thus send to all
+			sendSys = systemId == clientSystemId;
 		}
+		else if (ClientInfo[client].dieMsg == DIEMSG_SYSTEM && systemId == clientSystemId)
+			sendSys = true;
+		else if (ClientInfo[client].dieMsg == DIEMSG_SELF && (client == clientVictim || client == clientKiller))
+			sendSys = true;
+		else if (ClientInfo[client].dieMsg == DIEMSG_ALL)
+			sendSys = systemId == clientSystemId;
 		else
-		{
-			sendXmlBuf = xmlBuf;
-			sendXmlRet = ret;
-			sendXmlBufSys = bufSys;
-			sendXmlSysRet = retSys;
-		}
-
-		if (!FLHookConfig::i()->userCommands.userCmdSetDieMsg)
-		{ // /set diemsg disabled, thus send to all
-			if (systemId == clientSystemId)
-				Hk::Message::FMsgSendChat(client, sendXmlBufSys, sendXmlSysRet);
-			else
-				Hk::Message::FMsgSendChat(client, sendXmlBuf, sendXmlRet);
 			continue;
-		}
 
-		if (ClientInfo[client].dieMsg == DIEMSG_NONE)
+		const bool small = config->userCommands.userCmdSetDieMsgSize && ClientInfo[client].dieMsgSize == CS_SMALL;
+		recipients[sendSys ? (small ? SmallSys : DefaultSys) : (small ? Small : Default)].push_back(client);
+	}
+
+	const std::wstring text = XMLText(msg);
+	for (int variant = Default; variant < VariantCount; variant++)
+	{
+		if (recipients[variant].empty())
 			continue;
-		else if ((ClientInfo[client].dieMsg == DIEMSG_SYSTEM) && (systemId == clientSystemId))
-			Hk::Message::FMsgSendChat(client, sendXmlBufSys, sendXmlSysRet);
-		else if (
-		    (ClientInfo[client].dieMsg == DIEMSG_SELF) &&
-		    ((client == clientVictim) || (client == clientKiller)))
-			Hk::Message::FMsgSendChat(client, sendXmlBufSys, sendXmlSysRet);
-		else if (ClientInfo[client].dieMsg == DIEMSG_ALL)
-		{
-			if (systemId == clientSystemId)
-				Hk::Message::FMsgSendChat(client, sendXmlBufSys, sendXmlSysRet);
-			else
-				Hk::Message::FMsgSendChat(client, sendXmlBuf, sendXmlRet);
-		}
+
+		const bool sys = variant == DefaultSys || variant == SmallSys;
+		std::wstring style = sys ? config->messages.msgStyle.deathMsgStyleSys : config->messages.msgStyle.deathMsgStyle;
+		if (variant == Small || variant == SmallSys)
+			style = SetSizeToSmall(style);
+
+		const std::wstring xml = L"<TRA data=\"" + style + L"\" mask=\"-1\"/> <TEXT>" + text + L"</TEXT>";
+		uint size;
+		if (Hk::Message::FMsgEncodeXML(xml, buffer.data(), buffer.size(), size).has_error())
+			return;
+
+		for (const uint client : recipients[variant])
+			Hk::Message::FMsgSendChat(client, buffer.data(), size);
 	}
 }
 
@@ -143,7 +116,7 @@ void __stdcall ShipDestroyed(DamageList* dmgList, DWORD* ecx, uint kill)
 				swprintf_s(systemName, L"%u", systemId);
 
 				if (!magic_enum::enum_integer(dmg.get_cause()))
-					dmg = ClientInfo[client].dmgLast;
+					dmg = ClientInfoCold[client].dmgLast;
 
 				DamageCause cause = dmg.get_cause();
 				const auto clientKiller = Hk::Client::GetClientIdByShip(dmg.get_inflictor_id());
@@ -263,7 +236,8 @@ void __stdcall ShipDestroyed(DamageList* dmgList, DWORD* ecx, uint kill)
 			}
 
 			ClientInfo[client].shipOld = ClientInfo[client].ship;
-			ClientInfo[client].ship = 0;
+			Hk::Client::SetClientShip(client, 0);
+			PlayerGrid::i()->Remove(client);
 		}
 	}
 	CATCH_HOOK({})
@@ -1,4 +1,5 @@
 ﻿#include "Global.hpp"
+#include "Features/PlayerGrid.hpp"
 #include <unordered_set>
 
 void __stdcall ShipDestroyed(DamageList* dmgList, DWORD* ecx, uint kill);
@@ -141,6 +142,7 @@ _CRCAntiCheat CRCAntiCheat;
 char* g_FLServerDataPtr;
 _GetShipInspect GetShipInspect;
 std::array<CLIENT_INFO, MaxClientId + 1> ClientInfo;
+std::array<CLIENT_INFO_COLD, MaxClientId + 1> ClientInfoCold;
 char szRepFreeFixOld[5];
 
 /**************************************************************************************************************
@@ -150,12 +152,16 @@ clear the clientinfo
 void ClearClientInfo(ClientId client)
 {
 	auto* info = &ClientInfo[client];
+	auto* cold = &ClientInfoCold[client];
 
 	info->dieMsg = DIEMSG_ALL;
-	info->ship = 0;
+	Hk::Client::SetClientShip(client, 0);
+	Hk::Client::SetClientCharacterName(client, L"");
+	Hk::Client::SetPlayerSystem(client, 0);
+	PlayerGrid::i()->Remove(client);
 	info->shipOld = 0;
 	info->tmSpawnTime = 0;
-	info->lstMoneyFix.clear();
+	cold->lstMoneyFix.clear();
 	info->iTradePartner = 0;
 	info->iBaseEnterTime = 0;
 	info->iCharMenuEnterTime = 0;
@@ -168,13 +174,14 @@ void ClearClientInfo(ClientId client)
 	info->tmF1TimeDisconnect = 0;
 
 	DamageList dmg;
-	info->dmgLast = dmg;
+	cold->dmgLast = dmg;
 	info->dieMsgSize = CS_DEFAULT;
 	info->chatSize = CS_DEFAULT;
 	info->chatStyle = CST_DEFAULT;
 
-	info->lstIgnore.clear();
-	info->wscHostname = L"";
+	cold->ignoreList.Clear();
+	cold->userCmdBudget = {};
+	cold->wscHostname = L"";
 	info->bEngineKilled = false;
 	info->bThrusterActivated = false;
 	info->bTradelane = false;
@@ -183,7 +190,7 @@ void ClearClientInfo(ClientId client)
 	info->bSpawnProtected = false;
 
 	// Reset the dmg list if this client was the inflictor
-	for (auto& i : ClientInfo)
+	for (auto& i : ClientInfoCold)
 	{
 		if (i.dmgLast.inflictorPlayerId == client)
 			i.dmgLast = dmg;
@@ -201,6 +208,7 @@ load settings from flhookhuser.ini
 void LoadUserSettings(ClientId client)
 {
 	auto* info = &ClientInfo[client];
+	auto* cold = &ClientInfoCold[client];
 
 	CAccount const* acc = Players.FindAccountFromClientID(client);
 	std::wstring dir = Hk::Client::GetAccountDirName(acc);
@@ -215,7 +223,7 @@ void LoadUserSettings(ClientId client)
 	info->chatStyle = (CHATSTYLE)IniGetI(scUserFile, "settings", "ChatStyle", CST_DEFAULT);
 
 	// read ignorelist
-	info->lstIgnore.clear();
+	cold->ignoreList.Clear();
 	for (int i = 1;; i++)
 	{
 		std::wstring wscIgnore = IniGetWS(scUserFile, "IgnoreList", std::to_string(i), L"");
@@ -225,7 +233,7 @@ void LoadUserSettings(ClientId client)
 		IGNORE_INFO ii;
 		ii.character = GetParam(wscIgnore, ' ', 0);
 		ii.wscFlags = GetParam(wscIgnore, ' ', 1);
-		info->lstIgnore.push_back(ii);
+		cold->ignoreList.Add(ii);
 	}
 }
 
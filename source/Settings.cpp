@@ -33,6 +33,13 @@ void LoadSettings()
 		config.general.noPVPSystemsHashed.emplace_back(systemId);
 	}
 
+	// Chat suppression
+	config.general.chatSuppressMatcher = {};
+	for (const auto& prefix : config.general.chatSuppressList)
+	{
+		config.general.chatSuppressMatcher.Add(prefix);
+	}
+
 	// No Beam Bases
 	config.general.noBeamBasesHashed.clear();
 	for (const auto& base : config.general.noBeamBases)
@@ -48,7 +55,8 @@ void LoadSettings()
 	#define CORE_REFL
 REFL_AUTO(type(FLHookConfig::General), field(antiDockKill), field(antiF1), field(changeCruiseDisruptorBehaviour), field(debugMode),
     field(disableCharfileEncryption), field(disconnectDelay), field(disableNPCSpawns), field(localTime), field(maxGroupSize), field(persistGroup),
-    field(reservedSlots), field(torpMissileBaseDamageMultiplier), field(logPerformanceTimers), field(chatSuppressList), field(noPVPSystems),
+    field(reservedSlots), field(torpMissileBaseDamageMultiplier), field(logPerformanceTimers),
+    field(characterSaveInterval), field(characterSaveBudget), field(chatSuppressList), field(noPVPSystems),
     field(antiBaseIdle), field(antiCharMenuIdle), field(noBeamBases));
 REFL_AUTO(type(FLHookConfig::Plugins), field(loadAllPlugins), field(plugins));
 REFL_AUTO(type(FLHookConfig::Socket), field(activated), field(port), field(wPort), field(ePort), field(eWPort), field(encryptionKey), field(passRightsMap));
@@ -57,7 +65,8 @@ REFL_AUTO(type(FLHookConfig::MsgStyle), field(msgEchoStyle), field(deathMsgStyle
     field(userCmdStyle), field(adminCmdStyle), field(deathMsgTextAdminKill), field(deathMsgTextPlayerKill), field(deathMsgTextSelfKill), field(deathMsgTextNPC),
     field(deathMsgTextSuicide));
 REFL_AUTO(type(FLHookConfig::UserCommands), field(userCmdSetDieMsg), field(userCmdSetDieMsgSize), field(userCmdSetChatFont), field(userCmdIgnore),
-    field(userCmdHelp), field(userCmdMaxIgnoreList), field(defaultLocalChat));
+    field(userCmdHelp), field(userCmdMaxIgnoreList), field(defaultLocalChat), field(userCmdRateLimitBurst), field(userCmdRateLimitPerMinute),
+    field(userCmdCostBudgetMs), field(userCmdCostBudgetPerMinuteMs), field(logThrottledUserCmds));
 REFL_AUTO(type(FLHookConfig::Bans), field(banAccountOnMatch), field(banWildcardsAndIPs));
 REFL_AUTO(type(FLHookConfig::Callsign), field(allowedFormations), field(disableRandomisedFormations), field(disableUsingAffiliationForCallsign));
 REFL_AUTO(type(FLHookConfig), field(general), field(plugins), field(socket), field(messages), field(userCommands), field(bans), field(callsign));